@@ -0,0 +1,789 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *
+ *              C E D A R
+ *          S O L U T I O N S       "Software done right."
+ *           S O F T W A R E
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *
+ * Copyright (c) 2000-2004,2007,2013,2014,2020,2024 Kenneth J. Pronovici.
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License,
+ * Version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Copies of the GNU General Public License are available from
+ * the Free Software Foundation website, http://www.gnu.org/.
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *
+ * Author   : Kenneth J. Pronovici <pronovic@ieee.org>
+ * Language : ANSI C
+ * Project  : banner
+ * Purpose  : Animated banners, drawn over and over in place on a terminal.
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/********************
+  File documentation
+ ********************/
+
+/** @file
+  * @author Kenneth J. Pronovici
+  * @brief  Animated banners, drawn over and over in place on a terminal.
+  *
+  * Each animation composes its frames on a screen_t, which holds the frame
+  * being composed and writes it out with show_frame().  Nothing is rendered
+  * from scratch once an animation is under way.  A marquee renders its whole
+  * string once, as a strip of rows wide enough that any window onto it can
+  * be copied out in one piece, so each frame costs one copy per row of the
+  * terminal's width, however long the string is.
+  *
+  * Only the first frame is written out in full.  The screen keeps a copy of
+  * what's on the terminal, and each frame after that is compared with it
+  * row by row: rows that haven't changed are passed over with a single
+  * memcmp(), and changed rows are scanned eight bytes at a time for the runs
+  * that differ.  Just those runs are written, each after a cursor movement
+  * to get to it, so the bytes sent for each frame depend on how much of it
+  * changed rather than on how big it is, which matters on slow serial lines
+  * and remote logins.  Runs close enough together are written as one, since
+  * moving the cursor past a few characters costs about as much as writing
+  * them again.
+  *
+  * A clock keeps a cell for each character it has drawn, rendered once: the
+  * digits, and the separators in its format, up front, and anything else the
+  * first time it turns up.  Each tick copies in only the cells that differ
+  * from the last tick, so usually just the last digit or two.
+  *
+  * Frames are drawn on absolute deadlines on the monotonic clock, so time
+  * spent drawing one frame doesn't push all of the later ones back.  If the
+  * terminal falls a whole frame behind, the missed frames are skipped rather
+  * than drawn in a hurry to catch up.
+  */
+
+
+/****************
+  Included files
+ ****************/
+
+#include "config.h"
+
+#include <stdio.h>
+
+#ifdef HAVE_STDLIB_H
+   #include <stdlib.h>
+#endif
+
+#ifdef HAVE_STRING_H
+   #include <string.h>
+#endif
+
+#include <errno.h>
+#include <limits.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "libbanner.h"
+#include "animate.h"
+
+
+/******************
+  Macro defintions
+ *******************/
+
+/** Longest cursor movement sequence, including its terminating null */
+#define MOVE_SIZE          (16)
+
+/** Longest text a clock shows, including its terminating null */
+#define CLOCK_TEXT_SIZE    (256)
+
+/** Characters that clocks render cells for up front, besides the separators */
+#define CLOCK_DIGITS       ("0123456789")
+
+/** How long after each second a clock ticks, in seconds, to be sure it has changed */
+#define CLOCK_MARGIN       (0.001)
+
+/** Fewest unchanged characters worth moving the cursor past, rather than writing again */
+#define DIFF_GAP           (8)
+
+
+/******************
+  Type definitions
+ ******************/
+
+/** A frame as wide as the terminal, and what was last written out. */
+typedef struct
+{
+   int width;        /**< Width of each frame line, not including the newline */
+   int height;       /**< Number of frame lines */
+   char *frame;      /**< Frame being composed, height lines of width characters and a newline */
+   char *last;       /**< Frame on the terminal, laid out the same way */
+   char *out;        /**< Changes to the terminal, built up before they're written */
+   long shown;       /**< Number of frames written out so far */
+} screen_t;
+
+/** A character, rendered once for a clock. */
+typedef struct
+{
+   char key[4];      /**< The character, in UTF-8 */
+   int length;       /**< Length of the character, in bytes */
+   int width;        /**< Width of the rendered character */
+   char *rows;       /**< Rendered character, a row of width characters for each frame line */
+} cell_t;
+
+/** Every cell a clock has rendered so far. */
+typedef struct
+{
+   const banner_font_t *font;    /**< Font the cells are drawn in */
+   int height;                   /**< Number of rows in each cell */
+   cell_t *cells;                /**< Cells rendered so far */
+   int count;                    /**< Number of cells in use */
+   int allocated;                /**< Number of cells allocated */
+} cells_t;
+
+
+/****************
+  now subroutine
+ ****************/
+/** Returns the time on a monotonic clock.
+  * @return Time in seconds from some fixed point.
+  */
+
+static double now(void)
+{
+   struct timespec ts;
+
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return(ts.tv_sec + ts.tv_nsec/1e9);
+}
+
+
+/**********************
+  wait_tick subroutine
+ **********************/
+/** Works out the next frame's deadline, and waits for it.
+  * Deadlines are a whole number of periods apart, so they never drift.  If a
+  * whole period has gone by since the deadline, the frames that were missed
+  * are skipped, and the next frame is drawn straight away.  Without
+  * clock_nanosleep(), the time left until the deadline is slept instead,
+  * and worked out again if the sleep is interrupted.
+  * @param deadline  Deadline of the last frame, updated to the next one's
+  * @param period    Time between frames, in seconds
+  */
+
+static void wait_tick(double *deadline, double period)
+{
+   struct timespec ts;
+   double current = now();
+
+   *deadline += period;
+   while(current >= *deadline + period)
+   {
+      *deadline += period;   /* fell behind, so skip what was missed */
+   }
+
+#ifdef HAVE_CLOCK_NANOSLEEP
+   ts.tv_sec = (time_t)*deadline;
+   ts.tv_nsec = (long)((*deadline - ts.tv_sec)*1e9);
+   while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR)
+   {
+      continue;
+   }
+#else
+   while(current < *deadline)
+   {
+      ts.tv_sec = (time_t)(*deadline - current);
+      ts.tv_nsec = (long)((*deadline - current - ts.tv_sec)*1e9);
+      if(nanosleep(&ts, NULL) == 0 || errno != EINTR)
+      {
+         break;
+      }
+      current = now();
+   }
+#endif
+}
+
+
+/**********************
+  write_out subroutine
+ **********************/
+/** Writes a buffer to standard output, all of it.
+  * @param data      Buffer to write
+  * @param length    Length of the buffer
+  * @return Boolean true (1) on success, boolean false (0) with errno set otherwise.
+  */
+
+static int write_out(const char *data, size_t length)
+{
+   ssize_t written = 0;
+
+   while(length > 0)
+   {
+      written = write(1, data, length);
+      if(written < 0 && errno == EINTR)
+      {
+         continue;
+      }
+      if(written <= 0)
+      {
+         return(0);
+      }
+      data += written;
+      length -= written;
+   }
+
+   return(1);
+}
+
+
+/*************************
+  close_screen subroutine
+ *************************/
+/** Frees everything allocated by open_screen().
+  * @param screen    Screen to close
+  */
+
+static void close_screen(screen_t *screen)
+{
+   free(screen->frame);
+   free(screen->last);
+   free(screen->out);
+   screen->frame = NULL;
+   screen->last = NULL;
+   screen->out = NULL;
+}
+
+
+/************************
+  open_screen subroutine
+ ************************/
+/** Sets up a screen, with a blank frame.
+  * @param screen    Screen to set up
+  * @param width     Width of each frame line
+  * @param height    Number of frame lines
+  * @return Boolean true (1) on success, boolean false (0) if there wasn't enough memory.
+  */
+
+static int open_screen(screen_t *screen, int width, int height)
+{
+   int i = 0;
+
+   screen->width = width;
+   screen->height = height;
+   screen->shown = 0;
+   screen->frame = (char *)malloc((size_t)height*(width + 1));
+   screen->last = (char *)malloc((size_t)height*(width + 1));
+   screen->out = (char *)malloc((size_t)height*(width + MOVE_SIZE*(width/DIFF_GAP + 2)) + 2*MOVE_SIZE);
+   if(screen->frame == NULL || screen->last == NULL || screen->out == NULL)
+   {
+      close_screen(screen);
+      return(0);
+   }
+
+   for(i=0; i<height; i++)
+   {
+      memset(screen->frame + (size_t)i*(width + 1), ' ', width);
+      screen->frame[(size_t)i*(width + 1) + width] = '\n';
+   }
+
+   return(1);
+}
+
+
+/************************
+  next_change subroutine
+ ************************/
+/** Finds the next character of a frame line that differs from the terminal.
+  * Unchanged characters are passed over eight at a time.
+  * @param line      Line of the frame being composed
+  * @param last      Same line of the frame on the terminal
+  * @param start     Where to start looking
+  * @param width     Width of the line
+  * @return Offset of the first character from @c start on that differs,
+  *         or @c width if none does.
+  */
+
+static int next_change(const char *line, const char *last, int start, int width)
+{
+   uint64_t word = 0;
+   uint64_t other = 0;
+   int j = start;
+
+   for(; j+(int)sizeof(word)<=width; j+=sizeof(word))
+   {
+      memcpy(&word, line + j, sizeof(word));
+      memcpy(&other, last + j, sizeof(other));
+      if(word != other)
+      {
+         break;
+      }
+   }
+   for(; j<width; j++)
+   {
+      if(line[j] != last[j])
+      {
+         break;
+      }
+   }
+
+   return(j);
+}
+
+
+/*************************
+  show_changes subroutine
+ *************************/
+/** Writes out the parts of a frame that differ from what's on the terminal.
+  * The cursor starts and finishes at the start of the line below the frame.
+  * Each run of changes is copied into the frame on the terminal as it's
+  * written, so the two are the same afterwards.
+  * @param screen    Screen to write out
+  * @return Boolean true (1) on success, boolean false (0) with errno set otherwise.
+  */
+
+static int show_changes(screen_t *screen)
+{
+   char *out = screen->out;
+   char *line = NULL;
+   char *last = NULL;
+   int row = screen->height;
+   int column = 0;
+   int start = 0;
+   int end = 0;
+   int i = 0;
+   int j = 0;
+
+   for(i=0; i<screen->height; i++)
+   {
+      line = screen->frame + (size_t)i*(screen->width + 1);
+      last = screen->last + (size_t)i*(screen->width + 1);
+      if(memcmp(line, last, screen->width) == 0)
+      {
+         continue;
+      }
+
+      start = next_change(line, last, 0, screen->width);
+      while(start < screen->width)
+      {
+         for(j=end=start+1; j<screen->width && j-end<DIFF_GAP; j++)
+         {
+            if(line[j] != last[j])
+            {
+               end = j + 1;
+            }
+         }
+
+         if(row != i)
+         {
+            out += sprintf(out, row > i ? "\033[%dA" : "\033[%dB", row > i ? row - i : i - row);
+            row = i;
+         }
+         if(column != start)
+         {
+            out += start == 0 ? sprintf(out, "\r") : sprintf(out, "\033[%dG", start + 1);
+         }
+
+         memcpy(out, line + start, end - start);
+         memcpy(last + start, line + start, end - start);
+         out += end - start;
+         column = end;
+
+         start = next_change(line, last, end, screen->width);
+      }
+   }
+
+   if(out == screen->out)
+   {
+      return(1);   /* nothing changed, so the cursor never moved */
+   }
+
+   out += sprintf(out, "\033[%dB", screen->height - row);
+   if(column != 0)
+   {
+      *out++ = '\r';
+   }
+
+   return(write_out(screen->out, out - screen->out));
+}
+
+
+/***********************
+  show_frame subroutine
+ ***********************/
+/** Writes out the frame composed on a screen.
+  * The first frame is written in full, and each one after that is written
+  * over the one before it, as changes.
+  * @param screen    Screen to write out
+  * @return Boolean true (1) on success, boolean false (0) with errno set otherwise.
+  */
+
+static int show_frame(screen_t *screen)
+{
+   size_t size = (size_t)screen->height*(screen->width + 1);
+
+   if(screen->shown++ > 0)
+   {
+      return(show_changes(screen));
+   }
+
+   memcpy(screen->last, screen->frame, size);
+   return(write_out(screen->frame, size));
+}
+
+
+/*************************
+  show_marquee subroutine
+ *************************/
+/** Scrolls a banner across the terminal, from right to left, over and over.
+  * The banner is rendered at its full width, and laid out as a strip of rows
+  * with a terminal's width of blanks after it, so that it scrolls all of the
+  * way off before it comes back.  The first terminal's width of the strip is
+  * repeated at its end, so a window that wraps around the end of the strip
+  * can still be copied in one piece.
+  * @param font      Font to draw the banner in
+  * @param string    String to scroll, which need not be null-terminated
+  * @param length    Length of the string
+  * @param maxwidth  Maximum width of any one frame line
+  * @param animation How to draw the frames
+  * @return Boolean true (1) on success, boolean false (0) with errno set otherwise.
+  */
+
+int show_marquee(const banner_font_t *font, const char *string, size_t length,
+                 int maxwidth, const animation_t *animation)
+{
+   banner_metrics_t metrics;
+   screen_t screen;
+   char *rendered = NULL;
+   char *strip = NULL;
+   char *row = NULL;
+   size_t period = 0;
+   size_t stride = 0;
+   size_t offset = 0;
+   double deadline = 0;
+   long count = 0;
+   int width = maxwidth > 1 ? maxwidth - 1 : 1;
+   int shown = 1;
+   int i = 0;
+
+   banner_measure(font, string, length, INT_MAX, &metrics);
+   period = (size_t)metrics.width + width;
+   stride = period + width;
+
+   rendered = (char *)malloc(metrics.size > 0 ? metrics.size : 1);
+   strip = (char *)malloc(metrics.height*stride);
+   if(rendered == NULL || strip == NULL || !open_screen(&screen, width, metrics.height))
+   {
+      free(rendered);
+      free(strip);
+      errno = ENOMEM;
+      return(0);
+   }
+
+   banner_render(font, string, &metrics, rendered, metrics.size);
+   for(i=0; i<metrics.height; i++)
+   {
+      row = strip + i*stride;
+      memcpy(row, rendered + (size_t)i*(metrics.width + 1), metrics.width);
+      memset(row + metrics.width, ' ', width);
+      memcpy(row + period, row, width);
+   }
+   free(rendered);
+
+   offset = metrics.width;   /* start with the banner just off to the right */
+   deadline = now();
+   for(count=0; shown && (animation->frames == 0 || count < animation->frames); count++)
+   {
+      if(count > 0)
+      {
+         wait_tick(&deadline, 1.0/animation->rate);
+      }
+
+      for(i=0; i<metrics.height; i++)
+      {
+         memcpy(screen.frame + (size_t)i*(width + 1), strip + i*stride + offset, width);
+      }
+
+      shown = show_frame(&screen);
+      offset = (offset + animation->step) % period;
+   }
+
+   close_screen(&screen);
+   free(strip);
+   return(shown);
+}
+
+
+/************************
+  char_length subroutine
+ ************************/
+/** Works out how long the character at the start of a string is.
+  * @param string    String to look at
+  * @param length    Length of the string, at least one byte
+  * @return Length of the character, in bytes.
+  */
+
+static int char_length(const char *string, size_t length)
+{
+   int count = 1;
+
+   while((size_t)count < length && count < 4 && ((unsigned char)string[count] & 0xC0) == 0x80)
+   {
+      count++;
+   }
+
+   return(count);
+}
+
+
+/**********************
+  find_cell subroutine
+ **********************/
+/** Finds the cell for a character, rendering it the first time.
+  * @param cells     Cells rendered so far
+  * @param string    Character to find, in UTF-8
+  * @param length    Length of the character, from char_length()
+  * @return Index of the cell, or -1 with errno set if it couldn't be rendered.
+  */
+
+static int find_cell(cells_t *cells, const char *string, int length)
+{
+   banner_metrics_t metrics;
+   cell_t *cell = NULL;
+   char *rendered = NULL;
+   int i = 0;
+
+   for(i=0; i<cells->count; i++)
+   {
+      if(cells->cells[i].length == length && memcmp(cells->cells[i].key, string, length) == 0)
+      {
+         return(i);
+      }
+   }
+
+   if(cells->count == cells->allocated)
+   {
+      cell = (cell_t *)realloc(cells->cells, (cells->allocated*2 + 16)*sizeof(cell_t));
+      if(cell == NULL)
+      {
+         errno = ENOMEM;
+         return(-1);
+      }
+      cells->cells = cell;
+      cells->allocated = cells->allocated*2 + 16;
+   }
+
+   banner_measure(cells->font, string, length, INT_MAX, &metrics);
+   cell = &cells->cells[cells->count];
+   rendered = (char *)malloc(metrics.size + 1);
+   cell->rows = (char *)malloc((size_t)cells->height*metrics.width + 1);
+   if(rendered == NULL || cell->rows == NULL)
+   {
+      free(rendered);
+      free(cell->rows);
+      errno = ENOMEM;
+      return(-1);
+   }
+
+   banner_render(cells->font, string, &metrics, rendered, metrics.size);
+   for(i=0; i<cells->height; i++)
+   {
+      memcpy(cell->rows + (size_t)i*metrics.width, rendered + (size_t)i*(metrics.width + 1), metrics.width);
+   }
+   free(rendered);
+
+   memcpy(cell->key, string, length);
+   cell->length = length;
+   cell->width = metrics.width;
+   return(cells->count++);
+}
+
+
+/***********************
+  free_cells subroutine
+ ***********************/
+/** Frees every cell a clock has rendered.
+  * @param cells     Cells to free
+  */
+
+static void free_cells(cells_t *cells)
+{
+   int i = 0;
+
+   for(i=0; i<cells->count; i++)
+   {
+      free(cells->cells[i].rows);
+   }
+   free(cells->cells);
+   cells->cells = NULL;
+   cells->count = 0;
+   cells->allocated = 0;
+}
+
+
+/***********************
+  open_cells subroutine
+ ***********************/
+/** Renders the cells a clock needs up front: the digits, and the characters
+  * in its format outside of its conversions.
+  * @param cells     Cells to set up
+  * @param font      Font to draw the cells in
+  * @param format    Format of the clock, as for strftime()
+  * @return Boolean true (1) on success, boolean false (0) with errno set otherwise.
+  */
+
+static int open_cells(cells_t *cells, const banner_font_t *font, const char *format)
+{
+   banner_metrics_t metrics;
+   size_t length = strlen(format);
+   size_t i = 0;
+   int count = 0;
+
+   banner_measure(font, "", 0, INT_MAX, &metrics);
+   cells->font = font;
+   cells->height = metrics.height;
+   cells->cells = NULL;
+   cells->count = 0;
+   cells->allocated = 0;
+
+   for(i=0; i<strlen(CLOCK_DIGITS); i++)
+   {
+      if(find_cell(cells, CLOCK_DIGITS + i, 1) < 0)
+      {
+         return(0);
+      }
+   }
+
+   for(i=0; i<length; i+=count)
+   {
+      if(format[i] == '%')
+      {
+         for(count=1; i+count < length && strchr("EO0123456789_-^#", format[i+count]) != NULL; count++)
+         {
+            continue;   /* flags and modifiers */
+         }
+         count = i+count < length ? count + 1 : count;
+      }
+      else
+      {
+         count = char_length(format + i, length - i);
+         if(find_cell(cells, format + i, count) < 0)
+         {
+            return(0);
+         }
+      }
+   }
+
+   return(1);
+}
+
+
+/***********************
+  show_clock subroutine
+ ***********************/
+/** Shows the time in a banner, ticking over once a second.
+  * Each tick lays out the cells for the time, copying in only the ones that
+  * aren't already there from the last tick.  Once a cell's width differs
+  * from the one it replaces, everything after it has moved, and is copied
+  * too.
+  * @param font      Font to draw the banner in
+  * @param format    Format of the time, as for strftime()
+  * @param maxwidth  Maximum width of any one frame line
+  * @param animation How to draw the frames; only the number of frames is used
+  * @return Boolean true (1) on success, boolean false (0) with errno set otherwise.
+  */
+
+int show_clock(const banner_font_t *font, const char *format, int maxwidth, const animation_t *animation)
+{
+   cells_t cells;
+   screen_t screen;
+   struct timespec ts;
+   struct tm tm;
+   char text[CLOCK_TEXT_SIZE];
+   int last[CLOCK_TEXT_SIZE];
+   int lastcount = 0;
+   int lastwidth = 0;
+   size_t length = 0;
+   size_t j = 0;
+   double deadline = 0;
+   long count = 0;
+   int width = maxwidth > 1 ? maxwidth - 1 : 1;
+   int shown = 1;
+   int moved = 0;
+   int cell = 0;
+   int chars = 0;
+   int x = 0;
+   int i = 0;
+
+   if(!open_cells(&cells, font, format) || !open_screen(&screen, width, cells.height))
+   {
+      free_cells(&cells);
+      errno = ENOMEM;
+      return(0);
+   }
+
+   tzset();
+   clock_gettime(CLOCK_REALTIME, &ts);
+   deadline = now() - ts.tv_nsec/1e9 + CLOCK_MARGIN;   /* just after the last second started */
+
+   for(count=0; shown && (animation->frames == 0 || count < animation->frames); count++)
+   {
+      if(count > 0)
+      {
+         wait_tick(&deadline, 1.0);
+      }
+
+      clock_gettime(CLOCK_REALTIME, &ts);
+      localtime_r(&ts.tv_sec, &tm);
+      length = strftime(text, sizeof(text), format, &tm);
+
+      moved = 0;
+      for(j=0, x=0, chars=0; j<length; j+=cells.cells[cell].length, chars++)
+      {
+         cell = find_cell(&cells, text + j, char_length(text + j, length - j));
+         if(cell < 0)
+         {
+            shown = 0;
+            break;
+         }
+         if(x + cells.cells[cell].width > width)
+         {
+            break;   /* doesn't fit, so it's dropped along with the rest */
+         }
+
+         if(moved || chars >= lastcount || last[chars] != cell)
+         {
+            moved = moved || chars >= lastcount || cells.cells[last[chars]].width != cells.cells[cell].width;
+            for(i=0; i<cells.height; i++)
+            {
+               memcpy(screen.frame + (size_t)i*(width + 1) + x,
+                      cells.cells[cell].rows + (size_t)i*cells.cells[cell].width, cells.cells[cell].width);
+            }
+         }
+
+         last[chars] = cell;
+         x += cells.cells[cell].width;
+      }
+
+      for(i=0; x<lastwidth && i<cells.height; i++)
+      {
+         memset(screen.frame + (size_t)i*(width + 1) + x, ' ', lastwidth - x);   /* time got narrower */
+      }
+      lastcount = chars;
+      lastwidth = x;
+
+      if(shown)
+      {
+         shown = show_frame(&screen);
+      }
+   }
+
+   close_screen(&screen);
+   free_cells(&cells);
+   return(shown);
+}
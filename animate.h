@@ -0,0 +1,111 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *
+ *              C E D A R
+ *          S O L U T I O N S       "Software done right."
+ *           S O F T W A R E
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *
+ * Copyright (c) 2000-2004,2007,2013,2014,2020,2024 Kenneth J. Pronovici.
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License,
+ * Version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Copies of the GNU General Public License are available from
+ * the Free Software Foundation website, http://www.gnu.org/.
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *
+ * Author   : Kenneth J. Pronovici <pronovic@ieee.org>
+ * Language : ANSI C
+ * Project  : banner
+ * Purpose  : Animated banners, drawn over and over in place on a terminal.
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/********************
+  File documentation
+ ********************/
+
+/** @file
+  * @author Kenneth J. Pronovici
+  * @brief  Animated banners, drawn over and over in place on a terminal.
+  *
+  * An animation is a series of frames, each as wide as the terminal, that
+  * are drawn one on top of another: after the first frame, only the parts
+  * of each frame that changed are written, with cursor movements to get to
+  * them.  Frames are drawn on a fixed schedule, a number of times a second.
+  */
+
+#ifndef ANIMATE_H
+#define ANIMATE_H
+/*{*/
+
+#include "libbanner.h"
+
+
+/******************
+  Macro defintions
+ *******************/
+
+/** Default number of frames drawn each second */
+#define ANIMATE_DEFAULT_RATE  (30)
+
+/** Most frames that may be drawn each second */
+#define ANIMATE_MAX_RATE      (1000)
+
+/** Default number of columns a marquee moves each frame */
+#define ANIMATE_DEFAULT_STEP  (1)
+
+/** Default format of a clock, as for strftime() */
+#define CLOCK_DEFAULT_FORMAT  ("%H:%M:%S")
+
+
+/******************
+  Type definitions
+ ******************/
+
+/** How an animation is drawn. */
+typedef struct
+{
+   int rate;         /**< Number of frames drawn each second */
+   int step;         /**< Number of columns a marquee moves each frame */
+   long frames;      /**< Number of frames to draw, or zero to carry on until interrupted */
+} animation_t;
+
+
+/***********************
+  Function declarations
+ ***********************/
+
+/** Scrolls a banner across the terminal, from right to left, over and over.
+  * The banner is rendered once, and each frame is a window onto it.
+  * @param font      Font to draw the banner in
+  * @param string    String to scroll, which need not be null-terminated
+  * @param length    Length of the string
+  * @param maxwidth  Maximum width of any one frame line
+  * @param animation How to draw the frames
+  * @return Boolean true (1) on success, boolean false (0) with errno set otherwise.
+  */
+extern int show_marquee(const banner_font_t *font, const char *string, size_t length,
+                        int maxwidth, const animation_t *animation);
+
+/** Shows the time in a banner, ticking over at the start of every second.
+  * Each character is rendered once, and each tick copies in only the
+  * characters that changed.
+  * @param font      Font to draw the banner in
+  * @param format    Format of the time, as for strftime()
+  * @param maxwidth  Maximum width of any one frame line
+  * @param animation How to draw the frames; only the number of frames is used
+  * @return Boolean true (1) on success, boolean false (0) with errno set otherwise.
+  */
+extern int show_clock(const banner_font_t *font, const char *format, int maxwidth, const animation_t *animation);
+
+/*}*/
+#endif /* ifndef ANIMATE_H */
@@ -99,11 +99,12 @@
   * didn't feel like putting it in.  Adding it would be easy, if you want to
   * come up with letter definitions for the lower-case letters.
   *
-  * I could have made the add_to_banner() function prettier if I wanted to just
-  * key off of ASCII value rather than having hardcoded names for each
-  * letter/character.  I decided that keying off ASCII values would not be
-  * flexible enough.  If you want to optimize it, feel free, and then write me
-  * and let me know.
+  * These days, the banners are actually drawn by a small library, described
+  * in libbanner.h, which renders into a buffer supplied by the caller.  This
+  * program is just a client of that library: it works out what to print and
+  * how wide the terminal is, and writes out whatever the library renders.
+  * Fonts other than the one in letters.h can be compiled with banner-fontc
+  * (see fontc.c) and loaded at runtime with --font.
   *
   * @author Kenneth J. Pronovici
   */
@@ -125,23 +126,32 @@
    #include <string.h>
 #endif
 
-#ifdef HAVE_CTYPE_H
-   #include <ctype.h>
-#endif
-
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <unistd.h>
 #include <termios.h>
+#include <time.h>
 #include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+
+#ifdef HAVE_PTHREAD_H
+   #include <pthread.h>
+#endif
 
-#include "letters.h"
+#include "libbanner.h"
+#include "animate.h"
+#include "color.h"
+#include "profile.h"
+#include "server.h"
 
 
 /******************
   Macro defintions
  *******************/
 
-/** Initial size of banner arrays */
-#define INITIAL_SIZE       (10)
-
 /** Default print width (assumed terminal width) */
 #define DEFAULT_PRINTWIDTH (80)
 
@@ -151,410 +161,1291 @@
 /** Error exit status */
 #define ERROR_EXIT         (-1)
 
-/** URL of GNU's website */
-#define GNU_URL            ("http://www.gnu.org/")
+/** Initial size of banner buffers */
+#define INITIAL_SIZE       (4*1024)
+
+/** Default limit on the memory used by the banner cache */
+#define DEFAULT_CACHE_SIZE (1024*1024)
+
+/** Largest limit on the memory used by the banner cache that --cache may set */
+#define MAX_CACHE_SIZE     (1024*1024*1024)
+
+/** Size of the buffer used to read standard input */
+#define STDIN_BUFFER_SIZE  (64*1024)
+
+/** Default amount of output (in bytes) built up before it's written */
+#define DEFAULT_FLUSH_SIZE (64*1024)
+
+/** Largest amount of output (in bytes) that --flush may have built up */
+#define MAX_FLUSH_SIZE     (64*1024*1024)
+
+#ifndef IOV_MAX
+/** Most buffers that can be written with a single writev() */
+#define IOV_MAX            (16)
+#endif
+
+/** Approximate amount of a file (in bytes) rendered by each batch task */
+#define BATCH_CHUNK_SIZE   (4*1024)
+
+/** Number of command-line words rendered by each batch task */
+#define BATCH_CHUNK_WORDS  (64)
+
+/** Number of batch tasks that may be in flight for each worker thread */
+#define BATCH_WINDOW       (4)
+
+/** Most worker threads that --jobs may ask for */
+#define MAX_JOBS           (1024)
+
+/** URL of GNU's website */
+#define GNU_URL            ("http://www.gnu.org/")
+
+/** Copyright year range */
+#define COPYRIGHT_DATE     ("2000-2004,2007,2013")
+
+/** Name of author */
+#define AUTHOR             ("Kenneth J. Pronovici")
+
+/** Email address of author */
+#define AUTHOR_EMAIL       ("pronovic@ieee.org")
+
+
+/******************
+  Type definitions
+ ******************/
+
+/** Phases of a run that --stats reports the time spent in, and --profile the counts for. */
+typedef enum
+{
+   PHASE_PARSE,      /**< Handling the command-line arguments */
+   PHASE_WIDTH,      /**< Working out the print width */
+   PHASE_MEASURE,    /**< Measuring banners, which folds case and whitespace */
+   PHASE_RENDER,     /**< Rendering banners, or copying them from the cache */
+   PHASE_OUTPUT,     /**< Writing banners to standard output */
+   PHASE_COUNT       /**< Number of phases */
+} phase_t;
+
+/** Counters and timings reported by --stats. */
+typedef struct
+{
+   banner_stats_t render;        /**< Counters for the banners rendered */
+   unsigned long allocations;    /**< Number of allocations made for banner buffers */
+   size_t allocated;             /**< Total size of those allocations, in bytes */
+   size_t written;               /**< Number of bytes written to standard output */
+   double times[PHASE_COUNT];    /**< Time spent in each phase, in seconds */
+} stats_t;
+
+/** Growable buffer that banners are rendered into before being written. */
+typedef struct
+{
+   char *data;          /**< Rendered banners, ready to be written */
+   size_t length;       /**< Number of bytes of output */
+   size_t capacity;     /**< Number of bytes allocated at data */
+   size_t flush;        /**< Number of bytes of output built up before it's written */
+   char *scratch;       /**< Color runs and plain banner for --color, reused from banner to banner */
+   size_t scratchsize;  /**< Number of bytes allocated at scratch */
+   stats_t *stats;      /**< Counters to update as banners are filled and printed, or NULL */
+   profile_t *profile;  /**< Hardware counters to split between phases, or NULL */
+} output_t;
+
+/** How banners are rendered, which stays the same from banner to banner. */
+typedef struct
+{
+   const banner_font_t *font;    /**< Font to draw banners in */
+   banner_vertical_t *vertical;  /**< Font turned on its side for --vertical, or NULL */
+   banner_cache_t *cache;        /**< Cache of rendered banners, or NULL */
+   const color_t *color;         /**< Color laid over each banner, or NULL */
+   int maxwidth;                 /**< Maximum width of any one banner line */
+   int wrap;                     /**< Boolean true (1) to wrap strings that don't fit, rather than truncate them */
+   int warn;                     /**< Boolean true (1) to warn on standard error when a banner is truncated */
+   const char *program;          /**< Name the program was invoked with, for warnings */
+} options_t;
+
+#ifdef HAVE_PTHREAD_H
+
+/** One slot of the batch renderer's ring of in-flight tasks. */
+typedef struct
+{
+   char **words;        /**< Command-line words to render, or NULL for a file chunk */
+   int wordcount;       /**< Number of words to render */
+   const char *text;    /**< Start of the file chunk to render */
+   size_t length;       /**< Length of the file chunk */
+   output_t output;     /**< Rendered banners, reused from task to task */
+   stats_t stats;       /**< Counters for the output, added to the total once it's written */
+   int done;            /**< Boolean true (1) once the output is complete */
+} task_t;
+
+/** State shared between the batch renderer's worker threads and its writer. */
+typedef struct
+{
+   char **words;           /**< Remaining command-line words */
+   int wordcount;          /**< Number of remaining command-line words */
+   const char *text;       /**< Remaining file contents */
+   const char *end;        /**< End of the file contents */
+   options_t options;      /**< How to render banners, without a cache */
+   task_t *tasks;          /**< Ring of in-flight tasks */
+   int window;             /**< Number of slots in the ring */
+   long claimed;           /**< Number of tasks handed out to workers */
+   long written;           /**< Number of tasks written by the writer */
+   int finished;           /**< Boolean true (1) once all input is handed out */
+   pthread_mutex_t lock;   /**< Protects everything above except task output */
+   pthread_cond_t ready;   /**< Signalled when a task completes */
+   pthread_cond_t space;   /**< Signalled when a slot in the ring is freed */
+} batch_t;
+
+#endif /* HAVE_PTHREAD_H */
+
+
+/******************
+  Global variables
+ ******************/
+
+/** Names of the phases, as reported by --stats */
+static const char *phase_names[PHASE_COUNT] = { "parse", "width", "measure", "render", "output" };
+
+
+/****************
+  now subroutine
+ ****************/
+/** Returns the time on a monotonic clock, for --stats.
+  * @return Time in seconds from some fixed point.
+  */
+
+static double now(void)
+{
+   struct timespec ts;
+
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return(ts.tv_sec + ts.tv_nsec/1e9);
+}
+
+
+/**********************
+  add_stats subroutine
+ **********************/
+/** Adds one set of --stats counters into another, and clears it.
+  * @param total     Counters to add to
+  * @param part      Counters to add, which are zeroed afterwards
+  */
+
+static void add_stats(stats_t *total, stats_t *part)
+{
+   int i = 0;
+
+   total->render.banners += part->render.banners;
+   total->render.consumed += part->render.consumed;
+   total->render.glyphs += part->render.glyphs;
+   total->render.unknown += part->render.unknown;
+   total->render.truncated += part->render.truncated;
+   total->render.dropped += part->render.dropped;
+   total->render.bytes += part->render.bytes;
+   total->allocations += part->allocations;
+   total->allocated += part->allocated;
+   total->written += part->written;
+   for(i=0; i<PHASE_COUNT; i++)
+   {
+      total->times[i] += part->times[i];
+   }
+
+   memset(part, 0, sizeof(stats_t));
+}
+
+
+/************************
+  print_stats subroutine
+ ************************/
+/** Prints the --stats counters on standard error, as a single line of JSON.
+  * The cache's hits and misses are included, and are zero without a cache.
+  * @param stats     Counters to print
+  * @param cache     Cache of rendered banners, whose allocations are counted too, or NULL
+  */
+
+static void print_stats(const stats_t *stats, const banner_cache_t *cache)
+{
+   banner_cache_stats_t cachestats;
+   int i = 0;
+
+   memset(&cachestats, 0, sizeof(cachestats));
+   if(cache != NULL)
+   {
+      banner_cache_stats(cache, &cachestats);
+   }
+
+   fprintf(stderr, "{\"banners\":%lu,\"consumed\":%lu,\"glyphs\":%lu,\"unknown\":%lu,"
+                   "\"truncated\":%lu,\"dropped\":%lu,\"rendered_bytes\":%lu,"
+                   "\"allocations\":%lu,\"allocated_bytes\":%lu,\"written_bytes\":%lu,"
+                   "\"cache_hits\":%lu,\"cache_misses\":%lu,\"time_ns\":{",
+           stats->render.banners, stats->render.consumed, stats->render.glyphs, stats->render.unknown,
+           stats->render.truncated, stats->render.dropped, stats->render.bytes,
+           stats->allocations + cachestats.allocations,
+           (unsigned long)(stats->allocated + cachestats.allocated), (unsigned long)stats->written,
+           cachestats.hits, cachestats.misses);
+   for(i=0; i<PHASE_COUNT; i++)
+   {
+      fprintf(stderr, "%s\"%s\":%.0f", i > 0 ? "," : "", phase_names[i], stats->times[i]*1e9);
+   }
+   fprintf(stderr, "}}\n");
+}
+
+
+/************************
+  init_banner subroutine
+ ************************/
+/** Clears a banner buffer.
+  * No memory is allocated here; fill_banner() grows the buffer as needed, and
+  * reuses that allocation when the buffer is filled again.
+  * Note: any memory previously allocated to this buffer will be lost (leaked).
+  * The buffer's flush threshold and --stats counters are left alone.
+  * @param banner    Banner buffer to be initialized.
+  */
+
+static void init_banner(output_t *banner)
+{
+   banner->data = NULL;
+   banner->length = 0;
+   banner->capacity = 0;
+   banner->scratch = NULL;
+   banner->scratchsize = 0;
+}
+
+
+/************************
+  free_banner subroutine
+ ************************/
+/** Frees memory allocated by fill_banner().
+  * The buffer itself is not freed, only its contents.
+  * @param banner    Banner buffer to be freed.
+  */
+
+static void free_banner(output_t *banner)
+{
+   if(banner->data != NULL)
+   {
+      free(banner->data);
+   }
+
+   if(banner->scratch != NULL)
+   {
+      free(banner->scratch);
+   }
+
+   init_banner(banner);
+}
+
+
+/*************************
+  grow_scratch subroutine
+ *************************/
+/** Makes sure a banner buffer's scratch space is big enough.
+  * @param banner    Banner buffer
+  * @param size      Number of bytes of scratch space needed
+  * @return Boolean true (1) on success, boolean false (0) if there wasn't enough memory.
+  */
+
+static int grow_scratch(output_t *banner, size_t size)
+{
+   char *scratch = NULL;
+
+   if(size <= banner->scratchsize)
+   {
+      return(1);
+   }
+
+   scratch = (char *)realloc(banner->scratch, size);
+   if(scratch == NULL)
+   {
+      return(0);
+   }
+
+   banner->scratch = scratch;
+   banner->scratchsize = size;
+   if(banner->stats != NULL)
+   {
+      banner->stats->allocations++;
+      banner->stats->allocated += size;
+   }
+
+   return(1);
+}
+
+
+/***********************
+  fill_block subroutine
+ ***********************/
+/** Renders a string as a single banner onto the end of a banner buffer.
+  * The banner is surrounded by blank lines, as it has always been printed.
+  * The banner's size is known before it's rendered, so the buffer only has
+  * to be grown (once) if it isn't already big enough.  If that fails, the
+  * banner is left out.  If there is a cache, the banner is copied from the
+  * cache instead of being rendered here.  Characters that don't fit are
+  * never looked at, but with --warn their number is reported.  With --stats,
+  * the banner is counted and the time spent on it is added up, and with
+  * --profile, the hardware counters are split between measuring and rendering.
+  * With --color, the banner is rendered into scratch space instead, and then
+  * copied into the buffer with the color laid over it.
+  * @param banner    Banner buffer, as set up by init_banner()
+  * @param options   How to render the banner
+  * @param string    String to be filled into banner buffer, which need not be null-terminated
+  * @param length    Length of the string
+  */
+
+static void fill_block(output_t *banner, const options_t *options, const char *string, size_t length)
+{
+   banner_metrics_t metrics;
+   const char *cached = NULL;
+   const char *plain = NULL;
+   size_t runs = 0;
+   size_t needed = 0;
+   size_t capacity = 0;
+   char *data = NULL;
+   double start = 0;
+   double finish = 0;
+
+   if(banner->stats != NULL)
+   {
+      start = now();
+   }
+
+   if(banner->profile != NULL)
+   {
+      profile_enter(banner->profile, options->cache != NULL ? PHASE_RENDER : PHASE_MEASURE);
+   }
+
+   if(options->cache != NULL)
+   {
+      cached = banner_cache_render(options->cache, options->font, string, length, options->maxwidth, &metrics);
+      if(cached == NULL)
+      {
+         if(banner->profile != NULL)
+         {
+            profile_leave(banner->profile);
+         }
+         return;
+      }
+   }
+   else
+   {
+      banner_measure(options->font, string, length, options->maxwidth, &metrics);
+   }
+
+   if(banner->profile != NULL && cached == NULL)
+   {
+      profile_enter(banner->profile, PHASE_RENDER);
+   }
+
+   if(banner->stats != NULL)
+   {
+      finish = now();
+      banner->stats->times[cached != NULL ? PHASE_RENDER : PHASE_MEASURE] += finish - start;
+      banner_stats_add(&banner->stats->render, &metrics);
+      start = finish;
+   }
+
+   if(options->warn && metrics.dropped > 0)
+   {
+      fprintf(stderr, "%s: banner truncated, %lu bytes dropped\n", options->program, (unsigned long)metrics.dropped);
+   }
+
+   needed = banner->length + metrics.size + 2;
+   if(options->color != NULL)
+   {
+      runs = 2*(metrics.width + 2)*sizeof(int);
+      if(!grow_scratch(banner, runs + metrics.size))
+      {
+         if(banner->profile != NULL)
+         {
+            profile_leave(banner->profile);
+         }
+         return;
+      }
+
+      plain = cached;
+      if(plain == NULL)
+      {
+         banner_render(options->font, string, &metrics, banner->scratch + runs, metrics.size);
+         plain = banner->scratch + runs;
+      }
+      needed = banner->length + color_bound(options->color, &metrics) + 2;
+   }
+
+   if(needed > banner->capacity)
+   {
+      capacity = banner->capacity > 0 ? banner->capacity : INITIAL_SIZE;
+      while(capacity < needed)
+      {
+         capacity *= 2;
+      }
+
+      data = (char *)realloc(banner->data, capacity);
+      if(data == NULL)
+      {
+         if(banner->profile != NULL)
+         {
+            profile_leave(banner->profile);
+         }
+         return;
+      }
+
+      banner->data = data;
+      banner->capacity = capacity;
+      if(banner->stats != NULL)
+      {
+         banner->stats->allocations++;
+         banner->stats->allocated += capacity;
+      }
+   }
+
+   banner->data[banner->length++] = '\n';
+   if(plain != NULL)
+   {
+      banner->length += color_banner(options->color, options->font, string, &metrics, plain,
+                                     (int *)banner->scratch, banner->data + banner->length);
+   }
+   else if(cached != NULL)
+   {
+      memcpy(banner->data + banner->length, cached, metrics.size);
+      banner->length += metrics.size;
+   }
+   else
+   {
+      banner->length += banner_render(options->font, string, &metrics, banner->data + banner->length, metrics.size);
+   }
+   banner->data[banner->length++] = '\n';
+
+   if(banner->stats != NULL)
+   {
+      banner->stats->times[PHASE_RENDER] += now() - start;
+   }
+
+   if(banner->profile != NULL)
+   {
+      profile_leave(banner->profile);
+   }
+}
+
+
+/************************
+  fill_banner subroutine
+ ************************/
+/** Renders a string onto the end of a banner buffer.
+  * Normally, that's a single banner, truncated if it doesn't fit.  When
+  * wrapping, it's as many banners as it takes to fit all of the string,
+  * each broken between words where possible.
+  * @param banner    Banner buffer, as set up by init_banner()
+  * @param options   How to render the banner
+  * @param string    String to be filled into banner buffer, which need not be null-terminated
+  * @param length    Length of the string
+  */
+
+static void fill_banner(output_t *banner, const options_t *options, const char *string, size_t length)
+{
+   size_t block = 0;
+   size_t next = 0;
+
+   if(!options->wrap)
+   {
+      fill_block(banner, options, string, length);
+      return;
+   }
+
+   do
+   {
+      block = banner_wrap(options->font, string, length, options->maxwidth, &next);
+      fill_block(banner, options, string, block);
+      string += next;
+      length -= next;
+   } while(length > 0);
+}
+
+
+/**********************
+  write_all subroutine
+ **********************/
+/** Writes a set of buffers to standard output with as few system calls as
+  * possible, one if the descriptor takes everything at once.
+  * @param iov       Buffers to write, which are used up as they're written
+  * @param count     Number of buffers, at most @c IOV_MAX
+  * @return Boolean true (1) on success, boolean false (0) otherwise.
+  */
+
+static int write_all(struct iovec *iov, int count)
+{
+   ssize_t written = 0;
+
+   for(;;)
+   {
+      while(count > 0 && iov->iov_len == 0)
+      {
+         iov++;
+         count--;
+      }
+
+      if(count == 0)
+      {
+         return(1);
+      }
+
+      written = writev(1, iov, count);
+      if(written < 0 && errno == EINTR)
+      {
+         continue;
+      }
+      if(written <= 0)
+      {
+         return(0);
+      }
+
+      while(written > 0 && (size_t)written >= iov->iov_len)
+      {
+         written -= iov->iov_len;
+         iov->iov_len = 0;
+         iov++;
+         count--;
+      }
+
+      if(written > 0)
+      {
+         iov->iov_base = (char *)iov->iov_base + written;
+         iov->iov_len -= written;
+      }
+   }
+}
+
+
+/*************************
+  flush_banner subroutine
+ *************************/
+/** Writes out everything in a banner buffer with a single system call, and
+  * then empties it so it can be filled again.  Standard output isn't used
+  * for banners, so there is nothing else to flush.  Errors are ignored, as
+  * they always have been.
+  * @param banner    Banner buffer
+  */
+
+static void flush_banner(output_t *banner)
+{
+   struct iovec iov;
+   double start = 0;
+
+   if(banner->length == 0)
+   {
+      return;
+   }
+
+   if(banner->stats != NULL)
+   {
+      start = now();
+   }
+
+   if(banner->profile != NULL)
+   {
+      profile_enter(banner->profile, PHASE_OUTPUT);
+   }
+
+   iov.iov_base = banner->data;
+   iov.iov_len = banner->length;
+   write_all(&iov, 1);
+
+   if(banner->profile != NULL)
+   {
+      profile_leave(banner->profile);
+   }
+
+   if(banner->stats != NULL)
+   {
+      banner->stats->written += banner->length;
+      banner->stats->times[PHASE_OUTPUT] += now() - start;
+   }
+
+   banner->length = 0;
+}
+
+
+/*************************
+  print_banner subroutine
+ *************************/
+/** Prints a banner buffer once enough output has built up in it.
+  * Banners are kept in the buffer until it holds at least the flush
+  * threshold, so that many small banners go out in one system call.
+  * @param banner    Banner buffer
+  */
+
+static void print_banner(output_t *banner)
+{
+   if(banner->length >= banner->flush)
+   {
+      flush_banner(banner);
+   }
+}
+
+
+/************************
+  show_banner subroutine
+ ************************/
+/** Fills a string into a banner buffer and prints it.
+  * @param banner    Banner buffer, as set up by init_banner()
+  * @param options   How to render the banner
+  * @param string    String to be printed, which need not be null-terminated
+  * @param length    Length of the string
+  */
+
+static void show_banner(output_t *banner, const options_t *options, const char *string, size_t length)
+{
+   fill_banner(banner, options, string, length);
+   print_banner(banner);
+}
+
+
+/***********************
+  show_stdin subroutine
+ ***********************/
+/** Prints a banner for each line read from standard input.
+  * The trailing newline (and carriage return, if any) is not printed.
+  * Standard input is read in large blocks, and a banner is printed for
+  * every complete line in each block.  Output builds up as usual, but is
+  * always written out before waiting for more input, so a banner never sits
+  * in the buffer while its line could have been shown.  The input buffer is
+  * only grown if a single line doesn't fit in it.
+  * @param banner    Banner buffer, as set up by init_banner()
+  * @param options   How to render banners
+  */
+
+static void show_stdin(output_t *banner, const options_t *options)
+{
+   char *buffer = NULL;
+   char *grown = NULL;
+   const char *text = NULL;
+   const char *scan = NULL;
+   const char *end = NULL;
+   const char *newline = NULL;
+   size_t capacity = STDIN_BUFFER_SIZE;
+   size_t filled = 0;
+   size_t length = 0;
+   ssize_t count = 0;
+
+   buffer = (char *)malloc(capacity);
+   if(buffer == NULL)
+   {
+      return;
+   }
+
+   for(;;)
+   {
+      if(filled == capacity)
+      {
+         grown = (char *)realloc(buffer, capacity*2);
+         if(grown == NULL)
+         {
+            break;   /* print what we have of the line */
+         }
+         buffer = grown;
+         capacity *= 2;
+      }
+
+      flush_banner(banner);   /* before (maybe) waiting for input */
+
+      count = read(0, buffer + filled, capacity - filled);
+      if(count < 0 && errno == EINTR)
+      {
+         continue;
+      }
+      if(count <= 0)
+      {
+         break;
+      }
+
+      /* Only the bytes just read can hold a newline, since the partial line can't */
+      text = buffer;
+      scan = buffer + filled;
+      end = buffer + filled + count;
+      while((newline = (const char *)memchr(scan, '\n', end - scan)) != NULL)
+      {
+         length = newline - text;
+         if(length > 0 && text[length - 1] == '\r')
+         {
+            length--;
+         }
+
+         show_banner(banner, options, text, length);
+         text = newline + 1;
+         scan = text;
+      }
+
+      filled = end - text;
+      if(text != buffer)
+      {
+         memmove(buffer, text, filled);
+      }
+   }
+
+   if(filled > 0)
+   {
+      /* last line has no newline */
+      length = filled;
+      if(buffer[length - 1] == '\r')
+      {
+         length--;
+      }
+
+      show_banner(banner, options, buffer, length);
+   }
+
+   free(buffer);
+}
+
+
+/**********************
+  next_line subroutine
+ **********************/
+/** Finds the next line in a block of text.
+  * The trailing newline (and carriage return, if any) is not part of the line.
+  * @param text      Start of the line
+  * @param end       End of the block of text
+  * @param length    Returns the length of the line
+  * @return Start of the following line, which is @c end after the last line.
+  */
+
+static const char *next_line(const char *text, const char *end, size_t *length)
+{
+   const char *newline = NULL;
+
+   newline = (const char *)memchr(text, '\n', end - text);
+   if(newline == NULL)
+   {
+      newline = end - 1;  /* last line has no newline */
+      *length = end - text;
+   }
+   else
+   {
+      *length = newline - text;
+   }
+
+   if(*length > 0 && text[*length - 1] == '\r')
+   {
+      (*length)--;
+   }
+
+   return(newline + 1);
+}
+
+
+#ifdef HAVE_PTHREAD_H
+
+/***********************
+  claim_task subroutine
+ ***********************/
+/** Hands the next chunk of input to a worker thread.
+  * Tasks are handed out in input order.  A worker may run ahead of the
+  * writer by at most the size of the ring, so this waits for a free slot.
+  * Must be called with the batch lock held.
+  * @param batch     Batch renderer state
+  * @return Task to render, or NULL if there is no more input.
+  */
+
+static task_t *claim_task(batch_t *batch)
+{
+   task_t *task = NULL;
+   const char *text = NULL;
+   size_t length = 0;
+
+   while(!batch->finished && batch->claimed - batch->written >= batch->window)
+   {
+      pthread_cond_wait(&batch->space, &batch->lock);
+   }
+
+   if(batch->finished || (batch->wordcount == 0 && batch->text >= batch->end))
+   {
+      batch->finished = 1;
+      pthread_cond_broadcast(&batch->ready);
+      return(NULL);
+   }
+
+   task = &batch->tasks[batch->claimed % batch->window];
+   task->done = 0;
+   task->output.length = 0;
+
+   if(batch->wordcount > 0)
+   {
+      task->words = batch->words;
+      task->wordcount = batch->wordcount < BATCH_CHUNK_WORDS ? batch->wordcount : BATCH_CHUNK_WORDS;
+      batch->words += task->wordcount;
+      batch->wordcount -= task->wordcount;
+   }
+   else
+   {
+      /* take roughly a chunk's worth of text, finishing off the last line */
+      text = batch->end;
+      if((size_t)(batch->end - batch->text) > BATCH_CHUNK_SIZE)
+      {
+         text = next_line(batch->text + BATCH_CHUNK_SIZE - 1, batch->end, &length);
+      }
+      task->words = NULL;
+      task->text = batch->text;
+      task->length = text - batch->text;
+      batch->text = text;
+   }
+
+   batch->claimed++;
+   return(task);
+}
+
+
+/*************************
+  batch_worker subroutine
+ *************************/
+/** Worker thread for the batch renderer.
+  * Each worker renders whole tasks at a time, straight into the task's
+  * output buffer, which is reused from task to task.
+  * @param arg       Batch renderer state
+  * @return Always NULL.
+  */
+
+static void *batch_worker(void *arg)
+{
+   batch_t *batch = (batch_t *)arg;
+   task_t *task = NULL;
+   const char *line = NULL;
+   const char *text = NULL;
+   const char *end = NULL;
+   size_t length = 0;
+   int i = 0;
+
+   pthread_mutex_lock(&batch->lock);
+   while((task = claim_task(batch)) != NULL)
+   {
+      pthread_mutex_unlock(&batch->lock);
+
+      if(task->words != NULL)
+      {
+         for(i=0; i<task->wordcount; i++)
+         {
+            fill_banner(&task->output, &batch->options, task->words[i], strlen(task->words[i]));
+         }
+      }
+      else
+      {
+         end = task->text + task->length;
+         for(text=task->text; text<end; )
+         {
+            line = text;
+            text = next_line(line, end, &length);
+            fill_banner(&task->output, &batch->options, line, length);
+         }
+      }
+
+      pthread_mutex_lock(&batch->lock);
+      task->done = 1;
+      pthread_cond_broadcast(&batch->ready);
+   }
+   pthread_mutex_unlock(&batch->lock);
+
+   return(NULL);
+}
+
+
+/***********************
+  show_batch subroutine
+ ***********************/
+/** Prints banners for a batch of input using a pool of worker threads.
+  * The input is split into small tasks that workers claim one at a time, so
+  * long and short lines balance out across the pool.  The calling thread
+  * writes each task's output in input order as soon as it is complete, and
+  * whenever several tasks in a row are complete, their output is written
+  * with a single writev().
+  * @param words     Command-line words to print, or NULL
+  * @param wordcount Number of command-line words
+  * @param text      File contents to print a banner per line of, or NULL
+  * @param length    Length of the file contents
+  * @param options   How to render banners; the cache isn't used, since it can't be shared
+  * @param jobs      Number of worker threads
+  * @param stats     Counters to add the batch's --stats to, or NULL; the time
+  *                  spent by each worker is added up
+  * @return Boolean true (1) if the batch was printed, boolean false (0) if no workers could be started.
+  */
+
+static int show_batch(char **words, int wordcount, const char *text, size_t length,
+                      const options_t *options, int jobs, stats_t *stats)
+{
+   batch_t batch;
+   pthread_t *threads = NULL;
+   task_t *task = NULL;
+   struct iovec *iov = NULL;
+   int iovmax = 0;
+   int count = 0;
+   int started = 0;
+   int i = 0;
+   double start = 0;
+
+   memset(&batch, 0, sizeof(batch));
+   batch.words = words;
+   batch.wordcount = wordcount;
+   batch.text = text;
+   batch.end = text + length;
+   batch.options = *options;
+   batch.options.cache = NULL;
+   batch.window = BATCH_WINDOW*jobs;
+   iovmax = batch.window < IOV_MAX ? batch.window : IOV_MAX;
+
+   batch.tasks = (task_t *)calloc(batch.window, sizeof(task_t));
+   threads = (pthread_t *)calloc(jobs, sizeof(pthread_t));
+   iov = (struct iovec *)calloc(iovmax, sizeof(struct iovec));
+   if(batch.tasks == NULL || threads == NULL || iov == NULL)
+   {
+      free(batch.tasks);
+      free(threads);
+      free(iov);
+      return(0);
+   }
+
+   if(stats != NULL)
+   {
+      stats->allocations += 3;
+      stats->allocated += batch.window*sizeof(task_t) + jobs*sizeof(pthread_t) + iovmax*sizeof(struct iovec);
+      for(i=0; i<batch.window; i++)
+      {
+         batch.tasks[i].output.stats = &batch.tasks[i].stats;
+      }
+   }
+
+   pthread_mutex_init(&batch.lock, NULL);
+   pthread_cond_init(&batch.ready, NULL);
+   pthread_cond_init(&batch.space, NULL);
+
+   for(started=0; started<jobs; started++)
+   {
+      if(pthread_create(&threads[started], NULL, batch_worker, &batch) != 0)
+      {
+         break;
+      }
+   }
+
+   if(started > 0)
+   {
+      pthread_mutex_lock(&batch.lock);
+      for(;;)
+      {
+         task = &batch.tasks[batch.written % batch.window];
+         while(!(batch.written < batch.claimed && task->done) &&
+               !(batch.finished && batch.written == batch.claimed))
+         {
+            pthread_cond_wait(&batch.ready, &batch.lock);
+         }
+
+         if(batch.written == batch.claimed)
+         {
+            break;   /* all input handed out and written */
+         }
+
+         for(count=0; count<iovmax && batch.written + count < batch.claimed; count++)
+         {
+            task = &batch.tasks[(batch.written + count) % batch.window];
+            if(!task->done)
+            {
+               break;
+            }
+            iov[count].iov_base = task->output.data;
+            iov[count].iov_len = task->output.length;
+         }
+
+         pthread_mutex_unlock(&batch.lock);
+         if(stats != NULL)
+         {
+            start = now();
+         }
+
+         write_all(iov, count);
+
+         if(stats != NULL)
+         {
+            stats->times[PHASE_OUTPUT] += now() - start;
+            for(i=0; i<count; i++)
+            {
+               task = &batch.tasks[(batch.written + i) % batch.window];
+               stats->written += task->output.length;
+               add_stats(stats, &task->stats);
+            }
+         }
+         pthread_mutex_lock(&batch.lock);
+
+         batch.written += count;
+         pthread_cond_broadcast(&batch.space);
+      }
+      pthread_mutex_unlock(&batch.lock);
+
+      for(i=0; i<started; i++)
+      {
+         pthread_join(threads[i], NULL);
+      }
+   }
+
+   for(i=0; i<batch.window; i++)
+   {
+      free_banner(&batch.tasks[i].output);
+   }
 
-/** Copyright year range */
-#define COPYRIGHT_DATE     ("2000-2004,2007,2013")
+   pthread_cond_destroy(&batch.space);
+   pthread_cond_destroy(&batch.ready);
+   pthread_mutex_destroy(&batch.lock);
+   free(batch.tasks);
+   free(threads);
+   free(iov);
 
-/** Name of author */
-#define AUTHOR             ("Kenneth J. Pronovici")
+   return(started > 0);
+}
 
-/** Email address of author */
-#define AUTHOR_EMAIL       ("pronovic@ieee.org")
+#endif /* HAVE_PTHREAD_H */
 
 
-/************************
-  init_banner subroutine
- ************************/
-/** Does initial memory allocation and clears banner buffer. 
-  * Note: any memory previously allocated to this buffer will be lost (leaked).
-  * @param banner    Banner buffer to be initialized.
+/*********************
+  map_file subroutine
+ *********************/
+/** Maps a file into memory read-only.
+  * @param filename  Name of the file to map
+  * @param length    Returns the length of the file
+  * @return Start of the mapping, or NULL with errno set if the file couldn't
+  *         be mapped.  Empty files can't be mapped, so an empty file returns
+  *         a non-NULL pointer to an empty string, which must not be unmapped.
   */
 
-static void init_banner(char **banner)
+static const char *map_file(char *filename, size_t *length)
 {
-   int i = 0;
- 
-   for(i=0; i<LETTER_HEIGHT; i++)
+   int fd = -1;
+   int error = 0;
+   struct stat st;
+   const char *contents = NULL;
+
+   fd = open(filename, O_RDONLY);
+   if(fd < 0)
    {
-      banner[i] = (char *)calloc(1, INITIAL_SIZE*sizeof(char));
+      return(NULL);
    }
-}
 
+   if(fstat(fd, &st) != 0)
+   {
+      error = errno;
+      close(fd);
+      errno = error;
+      return(NULL);
+   }
 
-/************************
-  free_banner subroutine
- ************************/
-/** Frees memory allocated by init_banner().
-  * The array itself is not freed, only the allocations for the individual elements.
-  * @param banner    Banner buffer to be freed.
-  */
+   *length = st.st_size;
+   if(*length == 0)
+   {
+      close(fd);
+      return("");
+   }
 
-static void free_banner(char **banner)
-{
-   int i = 0;
- 
-   for(i=0; i<LETTER_HEIGHT; i++)
+   contents = (const char *)mmap(NULL, *length, PROT_READ, MAP_PRIVATE, fd, 0);
+   error = errno;
+   close(fd);
+   if(contents == MAP_FAILED)
    {
-      if(banner[i] != NULL)
-      {
-         free(banner[i]);
-         banner[i] = NULL;
-      }
+      errno = error;
+      return(NULL);
    }
+
+#ifdef MADV_SEQUENTIAL
+   madvise((void *)contents, *length, MADV_SEQUENTIAL);
+#endif
+
+   return(contents);
 }
 
 
-/******************************
-  convert_to_upper subroutine
- ******************************/
-/** Destructively converts a string to all UPPER-CASE letters. 
-  * @param string    String to be converted.
+/**********************
+  show_file subroutine
+ **********************/
+/** Prints a banner for each line of a file.
+  * The file is mapped into memory read-only, and each line is handed to
+  * fill_banner() right where it sits in the mapping, without being copied.
+  * The trailing newline (and carriage return, if any) is not printed.
+  * @param banner    Banner buffer, as set up by init_banner()
+  * @param options   How to render banners
+  * @param filename  Name of the file to read
+  * @param jobs      Number of worker threads to render with
+  * @return Boolean true (1) if the file was read, boolean false (0) otherwise.
   */
 
-static void convert_to_upper(char *string)
+static int show_file(output_t *banner, const options_t *options, char *filename, int jobs)
 {
-   int i = 0;
-   
-   for(i=0; i<strlen(string); i++)
+   const char *contents = NULL;
+   const char *line = NULL;
+   const char *text = NULL;
+   const char *end = NULL;
+   size_t size = 0;
+   size_t length = 0;
+   int printed = 0;
+
+   contents = map_file(filename, &size);
+   if(contents == NULL)
    {
-      string[i] = toupper(string[i]);
+      return(0);
    }
-}
 
+#ifdef HAVE_PTHREAD_H
+   if(jobs > 1)
+   {
+      printed = show_batch(NULL, 0, contents, size, options, jobs, banner->stats);
+   }
+#endif
 
-/*******************************
-  convert_whitespace subroutine
- *******************************/
-/** Destructively converts all whitespace characters to space characters.
-  * @param string    String to be converted.
-  */
+   end = contents + size;
+   for(text=contents; !printed && text<end; )
+   {
+      line = text;
+      text = next_line(line, end, &length);
+      show_banner(banner, options, line, length);
+   }
 
-static void convert_whitespace(char *string)
-{
-   int i = 0;
-   
-   for(i=0; i<strlen(string); i++)
+   if(size > 0)
    {
-      if(isspace(string[i]))
-      {
-         string[i] = ' ';
-      }
+      munmap((void *)contents, size);
    }
+
+   return(1);
 }
 
 
 /**************************
-  add_to_banner subroutine
+  fill_vertical subroutine
  **************************/
-/** Tacks a letter into a banner buffer.
-  * @param banner    Banner buffer
-  * @param height    Height of letters
-  * @param space     Width (in characters) of space between letters
-  * @param letter    Letter to be added to the banner buffer
-  * @param maxwidth  Maximum width of any one banner line
-  * @return Boolean true (1) if output was truncated, boolean false (0) otherwise.
+/** Renders a string onto the end of a banner buffer as part of a vertical
+  * banner, writing the buffer out whenever it fills up.
+  * The buffer never holds more than the flush threshold (or one letter, if
+  * that's bigger), however long the string is, so a vertical banner runs in
+  * the same memory from start to finish.  With --stats, the bytes rendered
+  * and the time spent are added up, and with --profile, the hardware
+  * counters are charged to rendering.
+  * @param banner    Banner buffer, as set up by init_banner()
+  * @param options   How to render the banner, with a vertical font
+  * @param string    String to be rendered, which need not be null-terminated
+  * @param length    Length of the string
   */
 
-static int add_to_banner(char **banner, int height, int space, char letter, int maxwidth)
+static void fill_vertical(output_t *banner, const options_t *options, const char *string, size_t length)
 {
-   int i = 0;
-   int j = 0;
-   char *previous = NULL;
-   char **working_char = NULL;
-   int new_length = 0;
-
-   switch(letter)
-   {
-   case 'A':
-      working_char = char_a;
-      break;
-   case 'B':
-      working_char = char_b;
-      break;
-   case 'C':
-      working_char = char_c;
-      break;
-   case 'D':
-      working_char = char_d;
-      break;
-   case 'E':
-      working_char = char_e;
-      break;
-   case 'F':
-      working_char = char_f;
-      break;
-   case 'G':
-      working_char = char_g;
-      break;
-   case 'H':
-      working_char = char_h;
-      break;
-   case 'I':
-      working_char = char_i;
-      break;
-   case 'J':
-      working_char = char_j;
-      break;
-   case 'K':
-      working_char = char_k;
-      break;
-   case 'L':
-      working_char = char_l;
-      break;
-   case 'M':
-      working_char = char_m;
-      break;
-   case 'N':
-      working_char = char_n;
-      break;
-   case 'O':
-      working_char = char_o;
-      break;
-   case 'P':
-      working_char = char_p;
-      break;
-   case 'Q':
-      working_char = char_q;
-      break;
-   case 'R':
-      working_char = char_r;
-      break;
-   case 'S':
-      working_char = char_s;
-      break;
-   case 'T':
-      working_char = char_t;
-      break;
-   case 'U':
-      working_char = char_u;
-      break;
-   case 'V':
-      working_char = char_v;
-      break;
-   case 'W':
-      working_char = char_w;
-      break;
-   case 'X':
-      working_char = char_x;
-      break;
-   case 'Y':
-      working_char = char_y;
-      break;
-   case 'Z':
-      working_char = char_z;
-      break;
-   case '0':
-      working_char = char_0;
-      break;
-   case '1':
-      working_char = char_1;
-      break;
-   case '2':
-      working_char = char_2;
-      break;
-   case '3':
-      working_char = char_3;
-      break;
-   case '4':
-      working_char = char_4;
-      break;
-   case '5':
-      working_char = char_5;
-      break;
-   case '6':
-      working_char = char_6;
-      break;
-   case '7':
-      working_char = char_7;
-      break;
-   case '8':
-      working_char = char_8;
-      break;
-   case '9':
-      working_char = char_9;
-      break;
-   case '#':
-      working_char = char_hash;
-      break;
-   case '~':
-      working_char = char_tild;
-      break;
-   case '!':
-      working_char = char_excl;
-      break;
-   case '@':
-      working_char = char_atsg;
-      break;
-   case '$':
-      working_char = char_dolr;
-      break;
-   case '%':
-      working_char = char_prct;
-      break;
-   case '^':
-      working_char = char_crrt;
-      break;
-   case '&':
-      working_char = char_ampr;
-      break;
-   case '*':
-      working_char = char_star;
-      break;
-   case ')':
-      working_char = char_rpar;
-      break;
-   case '(':
-      working_char = char_lpar;
-      break;
-   case '_':
-      working_char = char_undr;
-      break;
-   case '+':
-      working_char = char_plus;
-      break;
-   case '=':
-      working_char = char_equl;
-      break;
-   case '}':
-      working_char = char_rbrc;
-      break;
-   case '{':
-      working_char = char_lbrc;
-      break;
-   case ']':
-      working_char = char_rbrk;
-      break;
-   case '[':
-      working_char = char_lbrk;
-      break;
-   case '|':
-      working_char = char_pipe;
-      break;
-   case '\\':
-      working_char = char_lsls;
-      break;
-   case ':':
-      working_char = char_coln;
-      break;
-   case ';':
-      working_char = char_scln;
-      break;
-   case '\"':
-      working_char = char_quot;
-      break;
-   case '\'':
-      working_char = char_squt;
-      break;
-   case '`':
-      working_char = char_btck;
-      break;
-   case '>':
-      working_char = char_rarw;
-      break;
-   case '<':
-      working_char = char_larw;
-      break;
-   case '.':
-      working_char = char_perd;
-      break;
-   case ',':
-      working_char = char_coma;
-      break;
-   case '?':
-      working_char = char_ques;
-      break;
-   case '/':
-      working_char = char_rsls;
-      break;
-   case '-':
-      working_char = char_dash;
-      break;
-   case ' ':
-      working_char = char_spac;
-      break;
-   default:
-      /* If we don't know about it, we'll just ignore it. */
-      return(0);
-   }
+   size_t position = 0;
+   size_t written = 0;
+   size_t capacity = 0;
+   char *data = NULL;
+   double start = 0;
 
-   for(i=0; i<height; i++)
+   for(;;)
    {
-      new_length = strlen(banner[i])*sizeof(char) +         /* current banner */
-                   strlen(working_char[i])*sizeof(char) +   /* new character  */
-                   space*sizeof(char) +                     /* the spaces     */
-                   1;                                       /* \0 character   */
-      
-      if(new_length > maxwidth)
+      if(banner->stats != NULL)
       {
-         return(1);  /* banner was truncated */
+         start = now();
       }
 
-      previous = banner[i];
-      banner[i] = (char *)realloc(banner[i], new_length);
-      if(banner[i] == NULL)
+      if(banner->profile != NULL)
       {
-         banner[i] = previous;
-         return(1);  /* act as if truncated */
-      } 
+         profile_enter(banner->profile, PHASE_RENDER);
+      }
 
-      strcat(banner[i], working_char[i]);
+      written = banner_vertical_render(options->vertical, string, length, &position,
+                                       banner->data + banner->length, banner->capacity - banner->length);
+      banner->length += written;
 
-      for(j=0; j<space; j++)
+      if(banner->profile != NULL)
       {
-         strcat(banner[i], " ");
+         profile_leave(banner->profile);
       }
-   }
 
-   return(0);  /* banner was not truncated */
-}
+      if(banner->stats != NULL)
+      {
+         banner->stats->render.bytes += written;
+         banner->stats->times[PHASE_RENDER] += now() - start;
+      }
 
+      if(position == length)
+      {
+         break;
+      }
 
-/************************
-  fill_banner subroutine
- ************************/
-/** Fills a banner buffer in based on a string.
-  * @param banner    Banner buffer
-  * @param string    String to be filled into banner buffer
-  * @param maxwidth  Maximum width of any one banner line
-  */
+      if(banner->length > 0)
+      {
+         flush_banner(banner);   /* and carry on where we left off */
+         continue;
+      }
 
-static void fill_banner(char **banner, char *string, int maxwidth)
-{
-   int j = 0;
-   int truncated = 0;
+      /* Not even one letter fits, so grow the buffer */
+      capacity = banner->capacity > 0 ? banner->capacity*2 : banner->flush > INITIAL_SIZE ? banner->flush : INITIAL_SIZE;
+      data = (char *)realloc(banner->data, capacity);
+      if(data == NULL)
+      {
+         return;
+      }
 
-   for(j=0; j<strlen(string); j++)
-   {
-      truncated = add_to_banner(banner, LETTER_HEIGHT, SPACE_WIDTH, string[j], maxwidth);
-      if(truncated)
+      banner->data = data;
+      banner->capacity = capacity;
+      if(banner->stats != NULL)
       {
-         break;      /* stop looping; the string is too long */
+         banner->stats->allocations++;
+         banner->stats->allocated += capacity;
       }
    }
+
+   if(banner->stats != NULL)
+   {
+      banner->stats->render.consumed += length;
+   }
+
+   print_banner(banner);
 }
 
 
-/*************************
-  print_banner subroutine
- *************************/
-/** Prints a banner buffer.
-  * @param banner    Banner buffer
+/**************************
+  show_vertical subroutine
+ **************************/
+/** Prints everything read from a file descriptor as one vertical banner.
+  * The input is read a block at a time, and each block is rendered before
+  * the next is read, so only one block of input and one buffer of output
+  * are ever held, however much there is.  Newlines are drawn as spaces, like
+  * any other whitespace.  A UTF-8 character split between two blocks is
+  * held back and rendered with the second one.  Output is always written out
+  * before waiting for more input, as for show_stdin().
+  * @param banner    Banner buffer, as set up by init_banner()
+  * @param options   How to render the banner, with a vertical font
+  * @param fd        File descriptor to read
+  * @return Boolean true (1) if everything was read, boolean false (0) otherwise.
   */
 
-static void print_banner(char **banner)
+static int show_vertical(output_t *banner, const options_t *options, int fd)
 {
-   int j = 0;
+   char *buffer = NULL;
+   size_t filled = 0;
+   size_t complete = 0;
+   ssize_t count = 0;
 
-   printf("\n");
+   buffer = (char *)malloc(STDIN_BUFFER_SIZE);
+   if(buffer == NULL)
+   {
+      return(0);
+   }
 
-   for(j=0; j<LETTER_HEIGHT; j++)
+   for(;;)
    {
-      printf("%s\n", banner[j]);
+      flush_banner(banner);   /* before (maybe) waiting for input */
+
+      count = read(fd, buffer + filled, STDIN_BUFFER_SIZE - filled);
+      if(count < 0 && errno == EINTR)
+      {
+         continue;
+      }
+      if(count <= 0)
+      {
+         break;
+      }
+
+      filled += count;
+      complete = banner_complete(buffer, filled);
+      fill_vertical(banner, options, buffer, complete);
+      filled -= complete;
+      memmove(buffer, buffer + complete, filled);
    }
 
-   printf("\n");
+   fill_vertical(banner, options, buffer, filled);
+   free(buffer);
+   return(count == 0);
 }
 
 
@@ -567,7 +1458,32 @@ static void print_banner(char **banner)
 
 static void usage(char *program)
 {
-   printf("Usage: %s string\n"
+   printf("Usage: %s [--] string...\n"
+          "       %s - | --stdin\n"
+          "       %s --file path\n"
+          "       %s --serve path\n"
+          "       %s --client path [--] string... | -\n"
+          "       %s --marquee [--rate N] [--step N] [--frames N] [--] string...\n"
+          "       %s --clock [format] [--frames N]\n"
+          "\n"
+          "Options may also include:\n"
+          "\n"
+          "  --jobs N      render with N threads\n"
+          "  --cache K     limit the cache of rendered banners to K kilobytes\n"
+          "  --flush K     write output once K kilobytes have built up (default %d)\n"
+          "  --font path   draw banners in a font compiled by banner-fontc\n"
+          "  --scale N     draw letters N times as big, or WxH to scale each way apart\n"
+          "  --vertical    print one banner down the page, with the letters on their side\n"
+          "  --rate N      draw N frames a second with --marquee (default %d)\n"
+          "  --step N      move N columns each frame with --marquee (default %d)\n"
+          "  --frames N    stop after N frames with --marquee or --clock, rather than carrying on\n"
+          "  --color MODE  color each letter, or shade the banner horizontal or vertical\n"
+          "  --colors LIST colors to use with --color, as RRGGBB,RRGGBB,...\n"
+          "  --truecolor   use 24-bit color with --color, rather than 256 colors\n"
+          "  --wrap        wrap strings that don't fit onto more banners between words\n"
+          "  --warn        report how much of each truncated string was dropped\n"
+          "  --stats       report counters and timings for the run, as a line of JSON\n"
+          "  --profile     report hardware performance counters for each phase\n"
           "\n"
           "This is a classic-style banner program similar to the one found in Solaris or\n"
           "AIX in the late 1990s.  It prints a short string to the console in very large\n"
@@ -579,12 +1495,49 @@ static void usage(char *program)
           "idea of the terminal size is used.  Otherwise, a terminal width of %d\n"
           "characters is assumed.\n"
           "\n"
+          "With - or --stdin, each line read from standard input is printed as its\n"
+          "own banner, until end of file.  With --file, each line of the named file is\n"
+          "printed as its own banner.\n"
+          "\n"
+          "With --vertical, the words, or everything read from standard input or the\n"
+          "file, are printed as one banner running down the page, with the letters on\n"
+          "their side, as line printers used to print them.  There's no limit on its\n"
+          "length.\n"
+          "\n"
+          "With --marquee, the words are printed as one banner that scrolls across the\n"
+          "terminal from right to left, over and over, until it's interrupted.  Each frame\n"
+          "is drawn over the one before it.\n"
+          "\n"
+          "With --clock, the time is printed as a banner that ticks over once a second,\n"
+          "until it's interrupted.  The format is as for strftime(3), %s by default.\n"
+          "\n"
+          "With --color letters, each letter gets the next color in the list, and with\n"
+          "--color horizontal or vertical, the banner is shaded from one color in the\n"
+          "list to the next, across or down it.  The default list is a rainbow.\n"
+          "\n"
+          "With --jobs N, words given on the command-line and lines read with --file are\n"
+          "rendered by a pool of N threads (or one per processor if N is 0).  Banners are\n"
+          "still printed in their original order.\n"
+          "\n"
+          "With --serve, a render daemon is started on the Unix domain socket at path,\n"
+          "and runs until it is interrupted or terminated.  With --client, words (or lines\n"
+          "of standard input) are rendered by the daemon at path rather than locally.\n"
+          "\n"
+          "When reading standard input or a file, and in the daemon, banners that have\n"
+          "already been rendered are kept in a cache, limited to %d kilobytes by default.\n"
+          "A limit of 0 turns the cache off.\n"
+          "\n"
+          "Output is written a block at a time, with one system call, once --flush\n"
+          "kilobytes have built up, and before waiting for more standard input.  A\n"
+          "limit of 0 writes each banner as soon as it's rendered.\n"
+          "\n"
           "This is %s %s.\n"
           "Copyright (c) %s %s <%s>.\n"
           "\n"
           "Distributed under the GNU General Public License.\n"
           "See %s for details on the GNU GPL.\n",
-           program, DEFAULT_PRINTWIDTH,
+           program, program, program, program, program, program, program, DEFAULT_FLUSH_SIZE/1024,
+           ANIMATE_DEFAULT_RATE, ANIMATE_DEFAULT_STEP, DEFAULT_PRINTWIDTH, CLOCK_DEFAULT_FORMAT, DEFAULT_CACHE_SIZE/1024,
            PACKAGE, VERSION, COPYRIGHT_DATE, 
            AUTHOR, AUTHOR_EMAIL, GNU_URL);
 }
@@ -597,12 +1550,15 @@ static void usage(char *program)
   * 
   * Command-line arguments are handled simplistically: if there are no
   * arguments, then a usage statement is printed and an error code is returned.
-  * If the first argument is "-h" or "--help", then a usage statement is
-  * displayed.  If the first argument is "--", then it is ignored, which
-  * provides a backwards-compatible way to print a banner containing "--help"
-  * or "-h".  Finally, if we haven't errored out or printed the usage
-  * statement, anything else left on the command-line is considered a word to
-  * be printed as a banner.
+  * Leading arguments are checked against the options described in usage().
+  * If one of them is "-h" or "--help", then a usage statement is displayed.
+  * The first argument that isn't an option ends the options, and an argument
+  * of "--" ends them and is otherwise ignored, which provides a
+  * backwards-compatible way to print a banner containing "--help" or "-h".
+  * Finally, if we haven't errored out or printed the usage statement,
+  * anything else left on the command-line is considered a word to be printed
+  * as a banner.  Exactly one source of input is allowed: words, standard
+  * input or a file.  The render daemon takes no input at all.
   */
 
 int main(int argc, char *argv[])
@@ -617,53 +1573,255 @@ int main(int argc, char *argv[])
 
    int wordcount = 0;
    char **wordlist = NULL;
+   int use_stdin = 0;
+   char *filename = NULL;
+   char *serve_path = NULL;
+   char *client_path = NULL;
+   char *font_path = NULL;
+   int xscale = 1;
+   int yscale = 1;
+   int wrap = 0;
+   int vertical = 0;
+   int marquee = 0;
+   const char *clock_format = NULL;
+   char *color_mode = NULL;
+   const char *color_list = COLOR_DEFAULT_COLORS;
+   int truecolor = 0;
+   color_t *color = NULL;
+   char *text = NULL;
+   size_t length = 0;
+   int warn = 0;
+   int fd = -1;
+   int show_stats = 0;
+   int show_profile = 0;
+   int sources = 0;
+   int jobs = 1;
+   char *end = NULL;
+   long value = 0;
+   unsigned long kilobytes = 0;
 
    char *columns = NULL;
    int printwidth = 0;
 
-   int truncated = 0;
-   char *banner[LETTER_HEIGHT];
-   char *string = NULL;
+   options_t options;
+   const banner_font_t *font = NULL;
+   size_t cache_size = DEFAULT_CACHE_SIZE;
+   size_t flush_size = DEFAULT_FLUSH_SIZE;
+   output_t banner;
+   stats_t stats;
+   profile_t *profile = NULL;
+   animation_t animation;
+   double start = 0;
 
 
    /******************
      Handle arguments
     ******************/
 
+   memset(&stats, 0, sizeof(stats));
+   animation.rate = ANIMATE_DEFAULT_RATE;
+   animation.step = ANIMATE_DEFAULT_STEP;
+   animation.frames = 0;
+   start = now();
+
    if(argc < 2)
    {
       usage(argv[0]);
       exit(ERROR_EXIT);
    }
 
-   if(strcmp(argv[1], "-h") == 0 || strcmp(argv[1], "--help") == 0)
-   {
-      usage(argv[0]);
-      exit(NORMAL_EXIT);   /* not an error */
-   }
-   
-   if(strcmp(argv[1], "--") == 0)
-   {
-      wordcount = argc > 2 ? argc - 2 : 0;
-      wordlist = argc > 2 ? argv + 2 : NULL;
-   }
-   else
+   for(i=1; i<argc; i++)
    {
-      wordcount = argc > 1 ? argc - 1 : 0;
-      wordlist = argc > 1 ? argv + 1 : NULL;
+      if(strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0)
+      {
+         usage(argv[0]);
+         exit(NORMAL_EXIT);   /* not an error */
+      }
+      else if(strcmp(argv[i], "-") == 0 || strcmp(argv[i], "--stdin") == 0)
+      {
+         use_stdin = 1;
+      }
+      else if(strcmp(argv[i], "--file") == 0)
+      {
+         if(i+1 >= argc)
+         {
+            usage(argv[0]);
+            exit(ERROR_EXIT);
+         }
+         filename = argv[++i];
+      }
+      else if(strcmp(argv[i], "--jobs") == 0 && i+1 < argc)
+      {
+         value = strtol(argv[++i], &end, 10);
+         if(end == argv[i] || *end != '\0' || value < 0 || value > MAX_JOBS)
+         {
+            usage(argv[0]);
+            exit(ERROR_EXIT);
+         }
+         jobs = (int)value;
+         if(jobs == 0)
+         {
+            jobs = sysconf(_SC_NPROCESSORS_ONLN) > 0 ? sysconf(_SC_NPROCESSORS_ONLN) : 1;
+         }
+      }
+      else if(strcmp(argv[i], "--cache") == 0 && i+1 < argc)
+      {
+         errno = 0;
+         kilobytes = strtoul(argv[++i], &end, 10);
+         if(end == argv[i] || *end != '\0' || errno != 0 || kilobytes > MAX_CACHE_SIZE/1024)
+         {
+            usage(argv[0]);
+            exit(ERROR_EXIT);
+         }
+         cache_size = (size_t)kilobytes*1024;
+      }
+      else if(strcmp(argv[i], "--flush") == 0 && i+1 < argc)
+      {
+         errno = 0;
+         kilobytes = strtoul(argv[++i], &end, 10);
+         if(end == argv[i] || *end != '\0' || errno != 0 || kilobytes > MAX_FLUSH_SIZE/1024)
+         {
+            usage(argv[0]);
+            exit(ERROR_EXIT);
+         }
+         flush_size = (size_t)kilobytes*1024;
+      }
+      else if(strcmp(argv[i], "--wrap") == 0)
+      {
+         wrap = 1;
+      }
+      else if(strcmp(argv[i], "--vertical") == 0)
+      {
+         vertical = 1;
+      }
+      else if(strcmp(argv[i], "--marquee") == 0)
+      {
+         marquee = 1;
+      }
+      else if(strcmp(argv[i], "--clock") == 0)
+      {
+         clock_format = i+1 < argc && argv[i+1][0] != '-' ? argv[++i] : CLOCK_DEFAULT_FORMAT;
+      }
+      else if(strcmp(argv[i], "--rate") == 0 && i+1 < argc)
+      {
+         errno = 0;
+         value = strtol(argv[++i], &end, 10);
+         if(end == argv[i] || *end != '\0' || errno != 0 || value < 1 || value > ANIMATE_MAX_RATE)
+         {
+            usage(argv[0]);
+            exit(ERROR_EXIT);
+         }
+         animation.rate = (int)value;
+      }
+      else if(strcmp(argv[i], "--step") == 0 && i+1 < argc)
+      {
+         errno = 0;
+         value = strtol(argv[++i], &end, 10);
+         if(end == argv[i] || *end != '\0' || errno != 0 || value < 1 || value > INT_MAX)
+         {
+            usage(argv[0]);
+            exit(ERROR_EXIT);
+         }
+         animation.step = (int)value;
+      }
+      else if(strcmp(argv[i], "--frames") == 0 && i+1 < argc)
+      {
+         errno = 0;
+         value = strtol(argv[++i], &end, 10);
+         if(end == argv[i] || *end != '\0' || errno != 0 || value < 1)
+         {
+            usage(argv[0]);
+            exit(ERROR_EXIT);
+         }
+         animation.frames = value;
+      }
+      else if(strcmp(argv[i], "--color") == 0 && i+1 < argc)
+      {
+         color_mode = argv[++i];
+         if(strcmp(color_mode, "letters") != 0 && strcmp(color_mode, "horizontal") != 0 && strcmp(color_mode, "vertical") != 0)
+         {
+            usage(argv[0]);
+            exit(ERROR_EXIT);
+         }
+      }
+      else if(strcmp(argv[i], "--colors") == 0 && i+1 < argc)
+      {
+         color_list = argv[++i];
+      }
+      else if(strcmp(argv[i], "--truecolor") == 0)
+      {
+         truecolor = 1;
+      }
+      else if(strcmp(argv[i], "--warn") == 0)
+      {
+         warn = 1;
+      }
+      else if(strcmp(argv[i], "--stats") == 0)
+      {
+         show_stats = 1;
+      }
+      else if(strcmp(argv[i], "--profile") == 0)
+      {
+         show_profile = 1;
+      }
+      else if(strcmp(argv[i], "--font") == 0 && i+1 < argc)
+      {
+         font_path = argv[++i];
+      }
+      else if(strcmp(argv[i], "--scale") == 0 && i+1 < argc)
+      {
+         xscale = (int)strtol(argv[++i], &end, 10);
+         yscale = *end == 'x' ? (int)strtol(end + 1, &end, 10) : xscale;
+         if(*end != '\0' || xscale < 1 || yscale < 1)
+         {
+            usage(argv[0]);
+            exit(ERROR_EXIT);
+         }
+      }
+      else if(strcmp(argv[i], "--serve") == 0 && i+1 < argc)
+      {
+         serve_path = argv[++i];
+      }
+      else if(strcmp(argv[i], "--client") == 0 && i+1 < argc)
+      {
+         client_path = argv[++i];
+      }
+      else if(strcmp(argv[i], "--") == 0)
+      {
+         i++;
+         break;
+      }
+      else
+      {
+         break;
+      }
    }
 
-   if(wordcount < 1)
+   wordcount = argc - i;
+   wordlist = argv + i;
+
+   sources = (wordcount > 0) + use_stdin + (filename != NULL);
+   if((serve_path != NULL || clock_format != NULL ? sources != 0 : sources != 1) ||
+      (serve_path != NULL && client_path != NULL) ||
+      (client_path != NULL && (filename != NULL || font_path != NULL || xscale > 1 || yscale > 1)) ||
+      (vertical && (serve_path != NULL || client_path != NULL || wrap)) ||
+      (marquee && (wordcount == 0 || serve_path != NULL || client_path != NULL || vertical || wrap || show_stats || show_profile)) ||
+      (clock_format != NULL && (serve_path != NULL || client_path != NULL || vertical || marquee || wrap || show_stats || show_profile)) ||
+      (color_mode != NULL && (serve_path != NULL || client_path != NULL || vertical || marquee || clock_format != NULL)) ||
+      ((show_stats || show_profile) && (serve_path != NULL || client_path != NULL)))
    {
       usage(argv[0]);
       exit(ERROR_EXIT);
    }
 
+   stats.times[PHASE_PARSE] = now() - start;
+
 
    /***********************
      Determine print width
     ***********************/
 
+   start = now();
    columns = getenv("COLUMNS");
    if(columns == NULL)
    {
@@ -680,24 +1838,226 @@ int main(int argc, char *argv[])
    {
       printwidth = atoi(columns);
    }
+   stats.times[PHASE_WIDTH] = now() - start;
+
+
+   /*****************************************
+     Print a banner for each word (or line)
+    *****************************************/
+
+   if(client_path != NULL)
+   {
+      if(!client_banners(client_path, use_stdin ? NULL : wordlist, wordcount, printwidth, wrap ? SERVE_FLAG_WRAP : 0))
+      {
+         fprintf(stderr, "%s: %s: %s\n", argv[0], client_path, strerror(errno));
+         exit(ERROR_EXIT);
+      }
+      exit(NORMAL_EXIT);
+   }
+
+   options.font = font_path != NULL ? banner_font_open(font_path) : banner_builtin_font();
+   options.vertical = NULL;
+   options.cache = NULL;
+   options.color = NULL;
+   options.maxwidth = printwidth;
+   options.wrap = wrap;
+   options.warn = warn;
+   options.program = argv[0];
+   if(options.font == NULL)
+   {
+      if(font_path != NULL)
+      {
+         fprintf(stderr, "%s: %s: %s\n", argv[0], font_path, errno == EINVAL ? "not a compiled font" : strerror(errno));
+      }
+      exit(ERROR_EXIT);
+   }
+
+   if(xscale > 1 || yscale > 1)
+   {
+      font = options.font;
+      options.font = banner_font_scale(font, xscale, yscale);
+      banner_font_close(font);
+      if(options.font == NULL)
+      {
+         fprintf(stderr, "%s: --scale: %s\n", argv[0], strerror(errno));
+         exit(ERROR_EXIT);
+      }
+   }
+
+   if(vertical)
+   {
+      options.vertical = banner_vertical_create(options.font, printwidth);
+      if(options.vertical == NULL)
+      {
+         fprintf(stderr, "%s: --vertical: %s\n", argv[0], strerror(ENOMEM));
+         exit(ERROR_EXIT);
+      }
+   }
+
+   if(clock_format != NULL)
+   {
+      if(!show_clock(options.font, clock_format, printwidth, &animation))
+      {
+         fprintf(stderr, "%s: --clock: %s\n", argv[0], strerror(errno));
+         exit(ERROR_EXIT);
+      }
+      banner_font_close(options.font);
+      exit(NORMAL_EXIT);
+   }
+
+   if(marquee)
+   {
+      for(i=0; i<wordcount; i++)
+      {
+         length += strlen(wordlist[i]) + 1;
+      }
+      text = (char *)malloc(length);
+      if(text == NULL)
+      {
+         fprintf(stderr, "%s: --marquee: %s\n", argv[0], strerror(ENOMEM));
+         exit(ERROR_EXIT);
+      }
+      for(i=0, length=0; i<wordcount; i++)
+      {
+         if(i > 0)
+         {
+            text[length++] = ' ';   /* words are set apart by a space */
+         }
+         memcpy(text + length, wordlist[i], strlen(wordlist[i]));
+         length += strlen(wordlist[i]);
+      }
+      if(!show_marquee(options.font, text, length, printwidth, &animation))
+      {
+         fprintf(stderr, "%s: --marquee: %s\n", argv[0], strerror(errno));
+         exit(ERROR_EXIT);
+      }
+      free(text);
+      banner_font_close(options.font);
+      exit(NORMAL_EXIT);
+   }
+
+   if(color_mode != NULL)
+   {
+      color = color_create(strcmp(color_mode, "letters") == 0 ? COLOR_LETTERS :
+                           strcmp(color_mode, "horizontal") == 0 ? COLOR_HORIZONTAL : COLOR_VERTICAL,
+                           color_list, truecolor);
+      if(color == NULL)
+      {
+         fprintf(stderr, "%s: --colors: %s\n", argv[0], errno == EINVAL ? "not a list of RRGGBB colors" : strerror(errno));
+         exit(ERROR_EXIT);
+      }
+      options.color = color;
+   }
+
+   if(cache_size > 0 && !vertical && (serve_path != NULL || use_stdin || filename != NULL))
+   {
+      options.cache = banner_cache_create(cache_size);   /* runs without one if this fails */
+   }
+
+   if(serve_path != NULL)
+   {
+      if(!serve_banners(serve_path, options.font, options.cache))
+      {
+         fprintf(stderr, "%s: %s: %s\n", argv[0], serve_path, strerror(errno));
+         exit(ERROR_EXIT);
+      }
+      exit(NORMAL_EXIT);
+   }
+
+   if(show_profile)
+   {
+      profile = profile_open(PHASE_COUNT);
+      if(profile == NULL)
+      {
+         fprintf(stderr, "%s: --profile: %s\n", argv[0], strerror(errno));
+         exit(ERROR_EXIT);
+      }
+      jobs = 1;   /* the counters only follow this thread */
+   }
+
+   init_banner(&banner);
+   banner.flush = flush_size;
+   banner.stats = show_stats ? &stats : NULL;
+   banner.profile = profile;
+
+   if(options.vertical != NULL)
+   {
+      if(use_stdin)
+      {
+         show_vertical(&banner, &options, 0);
+      }
+      else if(filename != NULL)
+      {
+         fd = open(filename, O_RDONLY);
+         if(fd < 0 || !show_vertical(&banner, &options, fd))
+         {
+            fprintf(stderr, "%s: %s: %s\n", argv[0], filename, strerror(errno));
+            free_banner(&banner);
+            exit(ERROR_EXIT);
+         }
+         close(fd);
+      }
+      else
+      {
+         for(i=0; i<wordcount; i++)
+         {
+            fill_vertical(&banner, &options, " ", i > 0);   /* words are set apart by a space */
+            fill_vertical(&banner, &options, wordlist[i], strlen(wordlist[i]));
+         }
+      }
+   }
+   else if(use_stdin)
+   {
+      show_stdin(&banner, &options);
+   }
+   else if(filename != NULL)
+   {
+      if(!show_file(&banner, &options, filename, jobs))
+      {
+         fprintf(stderr, "%s: %s: %s\n", argv[0], filename, strerror(errno));
+         free_banner(&banner);
+         exit(ERROR_EXIT);
+      }
+   }
+   else
+   {
+#ifdef HAVE_PTHREAD_H
+      if(jobs > 1 && show_batch(wordlist, wordcount, NULL, 0, &options, jobs, banner.stats))
+      {
+         wordcount = 0;   /* already printed */
+      }
+#endif
+
+      for(i=0; i<wordcount; i++)
+      {
+         show_banner(&banner, &options, wordlist[i], strlen(wordlist[i]));
+      }
+   }
 
+   flush_banner(&banner);
 
-   /******************************
-     Print a banner for each word
-    ******************************/
+   if(profile != NULL)
+   {
+      profile_leave(profile);   /* nothing after this is charged to a phase */
+   }
 
-   for(i=0; i<wordcount; i++)
+   if(show_stats)
    {
-      string = wordlist[i];
-      convert_to_upper(string);
-      convert_whitespace(string);
+      print_stats(&stats, options.cache);
+   }
 
-      init_banner(banner);
-      fill_banner(banner, string, printwidth);
-      print_banner(banner);
-      free_banner(banner);
+   if(profile != NULL)
+   {
+      profile_print(profile, stderr, phase_names);
+      profile_close(profile);
    }
 
+   free_banner(&banner);
+   banner_cache_destroy(options.cache);
+   color_destroy(color);
+   banner_vertical_destroy(options.vertical);
+   banner_font_close(options.font);
+
 
    /*****************
      Return normally
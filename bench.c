@@ -0,0 +1,720 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *
+ *              C E D A R
+ *          S O L U T I O N S       "Software done right."
+ *           S O F T W A R E
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *
+ * Copyright (c) 2000-2004,2007,2013,2014,2020,2024 Kenneth J. Pronovici.
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License,
+ * Version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Copies of the GNU General Public License are available from
+ * the Free Software Foundation website, http://www.gnu.org/.
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *
+ * Author   : Kenneth J. Pronovici <pronovic@ieee.org>
+ * Language : ANSI C
+ * Project  : banner
+ * Purpose  : Benchmark harness for the render path.
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/********************
+  File documentation
+ ********************/
+
+/** @file
+  * @author Kenneth J. Pronovici
+  * @brief  Benchmark harness for the render path.
+  *
+  * The banner-bench program times the renderer over a grid of string
+  * lengths, character mixes, print widths and batch sizes, and prints one
+  * tab-separated line per case, so that the results from two releases can be
+  * compared with diff or loaded into a spreadsheet.  It isn't built or
+  * installed by default; run it with <tt>make bench</tt>.  The cases are:
+  *
+    @verbatim
+
+      measure   banner_measure() alone
+      render    banner_measure() and banner_render() into a reused buffer
+      cache     banner_cache_render(), once the banner is in the cache
+      batch     a batch of banners built into one growing buffer and written
+                to /dev/null, as the banner program does for each line
+      program   the banner program itself, run with --file on a batch of
+                lines, with its output going to /dev/null
+
+    @endverbatim
+  *
+  * Each case is repeated, doubling the number of iterations, until a run
+  * takes at least the target time.  The columns are the time per input
+  * character in nanoseconds, the banner bytes produced per second (for
+  * @c measure, the bytes sized, and for @c program, the bytes the program
+  * should have printed), and the calls to malloc(), calloc() and
+  * realloc() per iteration.  Allocations are counted by wrapping the C
+  * library's allocator, which is only done with the GNU C library; elsewhere
+  * (and for @c program, which runs in another process) the column is @c -.
+  */
+
+
+/****************
+  Included files
+ ****************/
+
+#include "config.h"
+
+#include <stdio.h>
+
+#ifdef HAVE_STDLIB_H
+   #include <stdlib.h>
+#endif
+
+#ifdef HAVE_STRING_H
+   #include <string.h>
+#endif
+
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#include "libbanner.h"
+
+
+/******************
+  Macro defintions
+ *******************/
+
+/** Normal exit status */
+#define NORMAL_EXIT        (0)
+
+/** Error exit status */
+#define ERROR_EXIT         (-1)
+
+/** Default target time for each case, in milliseconds */
+#define DEFAULT_TARGET_MS  (20)
+
+/** Initial size of batch buffers, as in the banner program */
+#define INITIAL_SIZE       (4*1024)
+
+/** Size of the cache used by the cache case */
+#define CACHE_SIZE         (16*1024*1024)
+
+/** Number of elements in an array */
+#define COUNT(array)       (sizeof(array)/sizeof((array)[0]))
+
+#ifdef __GLIBC__
+/** Allocations are counted by wrapping the GNU C library's allocator */
+#define COUNT_ALLOCATIONS
+#endif
+
+
+/******************
+  Type definitions
+ ******************/
+
+/** Kinds of benchmark case. */
+typedef enum
+{
+   CASE_MEASURE,     /**< banner_measure() alone */
+   CASE_RENDER,      /**< banner_measure() and banner_render() */
+   CASE_CACHE,       /**< banner_cache_render() on a warm cache */
+   CASE_BATCH,       /**< A batch of banners built into one buffer and written */
+   CASE_PROGRAM      /**< The banner program run on a file */
+} case_kind_t;
+
+/** One benchmark case. */
+typedef struct
+{
+   case_kind_t kind;       /**< What is timed */
+   const char *mix;        /**< Name of the character mix */
+   const char *string;     /**< String to render, of the case's length */
+   size_t length;          /**< Length of the string */
+   int width;              /**< Print width */
+   int batch;              /**< Number of banners per iteration */
+} bench_case_t;
+
+/** Character mixes that strings are made from. */
+typedef struct
+{
+   const char *name;       /**< Name printed in the results */
+   const char *pattern;    /**< Characters repeated to make a string */
+} mix_t;
+
+/** Everything shared by the cases. */
+typedef struct
+{
+   const banner_font_t *font;    /**< Font to draw banners in */
+   banner_cache_t *cache;        /**< Cache for the cache case */
+   const char *program;          /**< Path of the banner program, or NULL */
+   char *scratch;                /**< Buffer for the render case */
+   size_t capacity;              /**< Size of the buffer at scratch */
+   int null;                     /**< Descriptor open on /dev/null */
+   double target;                /**< Target time for each case, in seconds */
+} bench_t;
+
+
+/******************
+  Global variables
+ ******************/
+
+/** Names of the case kinds, as printed in the results */
+static const char *case_names[] = { "measure", "render", "cache", "batch", "program" };
+
+/** Character mixes */
+static const mix_t mixes[] =
+{
+   { "upper",   "ABCDEFGHIJKLMNOPQRSTUVWXYZ" },
+   { "lower",   "the quick brown fox jumps over the lazy dog" },
+   { "mixed",   "Hello, World! 0123456789 $%&*()+-=?" },
+   { "unknown", "\001\002\003\177\200\201\202\203\376\377" },
+   { "utf8",    "Gr\303\274\303\237e, \316\232\317\214\317\203\316\274\316\265! " },
+};
+
+/** String lengths */
+static const size_t lengths[] = { 1, 8, 64, 4096 };
+
+/** Print widths */
+static const int widths[] = { 80, 1000 };
+
+/** Batch sizes */
+static const int batches[] = { 1, 64, 1024 };
+
+/** Name the program was invoked with, for error messages */
+static const char *program_name = "banner-bench";
+
+/** Number of allocations made so far */
+static unsigned long allocations = 0;
+
+/** Sink for results, so that the compiler can't optimize away the work */
+static volatile size_t sink = 0;
+
+
+/*********************
+  Allocation counting
+ *********************/
+
+#ifdef COUNT_ALLOCATIONS
+
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t count, size_t size);
+extern void *__libc_realloc(void *pointer, size_t size);
+
+/** Counts an allocation and passes it on to the C library. */
+void *malloc(size_t size)
+{
+   allocations++;
+   return(__libc_malloc(size));
+}
+
+/** Counts an allocation and passes it on to the C library. */
+void *calloc(size_t count, size_t size)
+{
+   allocations++;
+   return(__libc_calloc(count, size));
+}
+
+/** Counts an allocation and passes it on to the C library. */
+void *realloc(void *pointer, size_t size)
+{
+   allocations++;
+   return(__libc_realloc(pointer, size));
+}
+
+#endif /* COUNT_ALLOCATIONS */
+
+
+/*****************
+  fail subroutine
+ *****************/
+/** Prints an error message and exits.
+  * @param what      What failed
+  */
+
+static void fail(const char *what)
+{
+   fprintf(stderr, "%s: %s: %s\n", program_name, what, strerror(errno));
+   exit(ERROR_EXIT);
+}
+
+
+/********************
+  seconds subroutine
+ ********************/
+/** Returns the time on a monotonic clock.
+  * @return Time in seconds from some fixed point.
+  */
+
+static double seconds(void)
+{
+   struct timespec now;
+
+   clock_gettime(CLOCK_MONOTONIC, &now);
+   return(now.tv_sec + now.tv_nsec/1e9);
+}
+
+
+/************************
+  make_string subroutine
+ ************************/
+/** Makes a string by repeating a character mix.
+  * @param mix       Character mix to repeat
+  * @param length    Length of the string
+  * @return Null-terminated string, which the caller must free.
+  */
+
+static char *make_string(const mix_t *mix, size_t length)
+{
+   char *string = NULL;
+   size_t patternlength = strlen(mix->pattern);
+   size_t i = 0;
+
+   string = (char *)malloc(length + 1);
+   if(string == NULL)
+   {
+      fail("malloc");
+   }
+
+   for(i=0; i<length; i++)
+   {
+      string[i] = mix->pattern[i % patternlength];
+   }
+   string[length] = '\0';
+
+   return(string);
+}
+
+
+/************************
+  write_batch subroutine
+ ************************/
+/** Writes a file holding a batch of lines, for the program case.
+  * @param benchcase Case to write the file for
+  * @param path      Template for the file's path, as for mkstemp()
+  */
+
+static void write_batch(const bench_case_t *benchcase, char *path)
+{
+   FILE *stream = NULL;
+   int fd = 0;
+   int i = 0;
+
+   fd = mkstemp(path);
+   if(fd < 0 || (stream = fdopen(fd, "w")) == NULL)
+   {
+      fail(path);
+   }
+
+   for(i=0; i<benchcase->batch; i++)
+   {
+      fwrite(benchcase->string, 1, benchcase->length, stream);
+      fputc('\n', stream);
+   }
+
+   if(fclose(stream) != 0)
+   {
+      fail(path);
+   }
+}
+
+
+/************************
+  run_program subroutine
+ ************************/
+/** Runs the banner program once, on a file, with its output discarded.
+  * @param bench     Shared benchmark state
+  * @param benchcase Case being run
+  * @param path      Path of the file to print
+  */
+
+static void run_program(const bench_t *bench, const bench_case_t *benchcase, const char *path)
+{
+   char columns[32];
+   pid_t pid = 0;
+   int status = 0;
+
+   pid = fork();
+   if(pid < 0)
+   {
+      fail("fork");
+   }
+
+   if(pid == 0)
+   {
+      sprintf(columns, "%d", benchcase->width);
+      setenv("COLUMNS", columns, 1);
+      dup2(bench->null, 1);
+      execl(bench->program, bench->program, "--file", path, (char *)NULL);
+      _exit(127);
+   }
+
+   if(waitpid(pid, &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+   {
+      errno = ECHILD;
+      fail(bench->program);
+   }
+}
+
+
+/**********************
+  run_batch subroutine
+ **********************/
+/** Builds a batch of banners into one buffer and writes it out, the way the
+  * banner program does: each banner is measured, the buffer is grown if
+  * need be, and the banner is rendered in place between blank lines.
+  * @param bench     Shared benchmark state
+  * @param benchcase Case being run
+  * @return Number of bytes written.
+  */
+
+static size_t run_batch(const bench_t *bench, const bench_case_t *benchcase)
+{
+   banner_metrics_t metrics;
+   char *data = NULL;
+   char *grown = NULL;
+   size_t length = 0;
+   size_t capacity = INITIAL_SIZE;
+   int i = 0;
+
+   data = (char *)malloc(capacity);
+   if(data == NULL)
+   {
+      fail("malloc");
+   }
+
+   for(i=0; i<benchcase->batch; i++)
+   {
+      banner_measure(bench->font, benchcase->string, benchcase->length, benchcase->width, &metrics);
+      if(length + metrics.size + 2 > capacity)
+      {
+         while(length + metrics.size + 2 > capacity)
+         {
+            capacity *= 2;
+         }
+         grown = (char *)realloc(data, capacity);
+         if(grown == NULL)
+         {
+            fail("realloc");
+         }
+         data = grown;
+      }
+
+      data[length++] = '\n';
+      length += banner_render(bench->font, benchcase->string, &metrics, data + length, metrics.size);
+      data[length++] = '\n';
+   }
+
+   if(write(bench->null, data, length) != (ssize_t)length)
+   {
+      fail("write");
+   }
+
+   free(data);
+   return(length);
+}
+
+
+/*********************
+  run_once subroutine
+ *********************/
+/** Runs one iteration of a case.
+  * @param bench     Shared benchmark state
+  * @param benchcase Case to run
+  * @param path      Path of the batch file, for the program case
+  * @return Number of banner bytes produced.
+  */
+
+static size_t run_once(bench_t *bench, const bench_case_t *benchcase, const char *path)
+{
+   banner_metrics_t metrics;
+   char *grown = NULL;
+
+   switch(benchcase->kind)
+   {
+      case CASE_MEASURE:
+         banner_measure(bench->font, benchcase->string, benchcase->length, benchcase->width, &metrics);
+         sink += metrics.width;
+         return(metrics.size);
+
+      case CASE_RENDER:
+         banner_measure(bench->font, benchcase->string, benchcase->length, benchcase->width, &metrics);
+         if(metrics.size > bench->capacity)
+         {
+            grown = (char *)realloc(bench->scratch, metrics.size);
+            if(grown == NULL)
+            {
+               fail("realloc");
+            }
+            bench->scratch = grown;
+            bench->capacity = metrics.size;
+         }
+         sink += banner_render(bench->font, benchcase->string, &metrics, bench->scratch, bench->capacity);
+         return(metrics.size);
+
+      case CASE_CACHE:
+         if(banner_cache_render(bench->cache, bench->font, benchcase->string, benchcase->length,
+                                benchcase->width, &metrics) == NULL)
+         {
+            errno = ENOMEM;
+            fail("banner_cache_render");
+         }
+         sink += metrics.size;
+         return(metrics.size);
+
+      case CASE_BATCH:
+         return(run_batch(bench, benchcase));
+
+      case CASE_PROGRAM:
+         run_program(bench, benchcase, path);
+         banner_measure(bench->font, benchcase->string, benchcase->length, benchcase->width, &metrics);
+         return((metrics.size + 2)*benchcase->batch);
+   }
+
+   return(0);
+}
+
+
+/*********************
+  run_case subroutine
+ *********************/
+/** Times a case and prints a line of results.
+  * @param bench     Shared benchmark state
+  * @param benchcase Case to run
+  */
+
+static void run_case(bench_t *bench, const bench_case_t *benchcase)
+{
+   char path[] = "/tmp/banner-bench.XXXXXX";
+   unsigned long iterations = 0;
+   unsigned long count = 0;
+   unsigned long before = 0;
+   unsigned long allocated = 0;
+   size_t bytes = 0;
+   double start = 0;
+   double elapsed = 0;
+   double characters = 0;
+   int counted = 0;
+
+   if(benchcase->kind == CASE_PROGRAM)
+   {
+      write_batch(benchcase, path);
+   }
+
+   run_once(bench, benchcase, path);   /* warms the cache and the scratch buffer */
+
+   for(iterations=1; ; iterations*=2)
+   {
+      bytes = 0;
+      before = allocations;
+      start = seconds();
+      for(count=0; count<iterations; count++)
+      {
+         bytes += run_once(bench, benchcase, path);
+      }
+      elapsed = seconds() - start;
+      allocated = allocations - before;
+      if(elapsed >= bench->target)
+      {
+         break;
+      }
+   }
+
+   if(benchcase->kind == CASE_PROGRAM)
+   {
+      unlink(path);
+   }
+
+#ifdef COUNT_ALLOCATIONS
+   counted = benchcase->kind != CASE_PROGRAM;
+#endif
+
+   characters = (double)iterations*benchcase->length*benchcase->batch;
+   printf("%s\t%s\t%lu\t%d\t%d\t%lu\t%.3f\t%.0f\t",
+          case_names[benchcase->kind], benchcase->mix, (unsigned long)benchcase->length,
+          benchcase->width, benchcase->batch, iterations,
+          elapsed*1e9/characters, bytes/elapsed);
+   if(counted)
+   {
+      printf("%.3f\n", (double)allocated/iterations);
+   }
+   else
+   {
+      printf("-\n");
+   }
+   fflush(stdout);
+}
+
+
+/******************
+  usage subroutine
+ ******************/
+/** Prints usage information for the program.
+  * @param program   Name of the program
+  */
+
+static void usage(const char *program)
+{
+   printf("Usage: %s [--time ms] [--font path] [--scale N] [--banner path]\n"
+          "\n"
+          "Times the banner renderer over a range of string lengths, character mixes,\n"
+          "print widths and batch sizes, and prints the results as tab-separated\n"
+          "columns.  Each case runs for at least --time milliseconds (%d by default).\n"
+          "Banners are drawn in the built-in font, or in a font compiled by\n"
+          "banner-fontc with --font, and drawn N times as big with --scale.  With\n"
+          "--banner, the banner program at path is also timed end to end.\n",
+          program, DEFAULT_TARGET_MS);
+}
+
+
+/**************
+  Main routine
+ **************/
+/** Program main routine.
+  * @param argc      Number of arguments
+  * @param argv      Argument values
+  * @return Integer exit code, @c NORMAL_EXIT or @c ERROR_EXIT.
+  */
+
+int main(int argc, char *argv[])
+{
+   bench_t bench;
+   bench_case_t benchcase;
+   const char *font_path = NULL;
+   const banner_font_t *font = NULL;
+   int scale = 1;
+   char *strings[COUNT(mixes)][COUNT(lengths)];
+   size_t m = 0;
+   size_t l = 0;
+   size_t w = 0;
+   size_t b = 0;
+   int i = 0;
+
+   program_name = argv[0];
+   memset(&bench, 0, sizeof(bench));
+   bench.target = DEFAULT_TARGET_MS/1000.0;
+
+   for(i=1; i<argc; i++)
+   {
+      if(strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0)
+      {
+         usage(argv[0]);
+         exit(NORMAL_EXIT);
+      }
+      else if(strcmp(argv[i], "--time") == 0 && i+1 < argc)
+      {
+         bench.target = atoi(argv[++i])/1000.0;
+      }
+      else if(strcmp(argv[i], "--font") == 0 && i+1 < argc)
+      {
+         font_path = argv[++i];
+      }
+      else if(strcmp(argv[i], "--scale") == 0 && i+1 < argc)
+      {
+         scale = atoi(argv[++i]);
+      }
+      else if(strcmp(argv[i], "--banner") == 0 && i+1 < argc)
+      {
+         bench.program = argv[++i];
+      }
+      else
+      {
+         usage(argv[0]);
+         exit(ERROR_EXIT);
+      }
+   }
+
+   bench.font = font_path != NULL ? banner_font_open(font_path) : banner_builtin_font();
+   if(bench.font == NULL)
+   {
+      fail(font_path != NULL ? font_path : "banner_builtin_font");
+   }
+
+   if(scale != 1)
+   {
+      font = bench.font;
+      bench.font = banner_font_scale(font, scale, scale);
+      banner_font_close(font);
+      if(bench.font == NULL)
+      {
+         fail("--scale");
+      }
+   }
+
+   bench.cache = banner_cache_create(CACHE_SIZE);
+   bench.null = open("/dev/null", O_WRONLY);
+   if(bench.cache == NULL || bench.null < 0)
+   {
+      fail("setup");
+   }
+
+   for(m=0; m<COUNT(mixes); m++)
+   {
+      for(l=0; l<COUNT(lengths); l++)
+      {
+         strings[m][l] = make_string(&mixes[m], lengths[l]);
+      }
+   }
+
+   printf("# %s %s, %s font, scale %d\n", PACKAGE, VERSION, font_path != NULL ? font_path : "built-in", scale);
+   printf("case\tmix\tlength\twidth\tbatch\titerations\tns_per_char\tbytes_per_sec\tallocs_per_iter\n");
+
+   for(benchcase.kind=CASE_MEASURE; benchcase.kind<=CASE_PROGRAM; benchcase.kind++)
+   {
+      if(benchcase.kind == CASE_PROGRAM && bench.program == NULL)
+      {
+         continue;
+      }
+
+      for(m=0; m<COUNT(mixes); m++)
+      {
+         for(l=0; l<COUNT(lengths); l++)
+         {
+            for(w=0; w<COUNT(widths); w++)
+            {
+               for(b=0; b<COUNT(batches); b++)
+               {
+                  benchcase.mix = mixes[m].name;
+                  benchcase.string = strings[m][l];
+                  benchcase.length = lengths[l];
+                  benchcase.width = widths[w];
+                  benchcase.batch = batches[b];
+
+                  /* Only batches are worth timing in batches, and only one width of them */
+                  if(benchcase.kind < CASE_BATCH ? benchcase.batch != 1 :
+                     (benchcase.batch == 1 || benchcase.width != widths[0]))
+                  {
+                     continue;
+                  }
+
+                  run_case(&bench, &benchcase);
+               }
+            }
+         }
+      }
+   }
+
+   for(m=0; m<COUNT(mixes); m++)
+   {
+      for(l=0; l<COUNT(lengths); l++)
+      {
+         free(strings[m][l]);
+      }
+   }
+   free(bench.scratch);
+   banner_cache_destroy(bench.cache);
+   banner_font_close(bench.font);
+   close(bench.null);
+
+   return(NORMAL_EXIT);
+}
@@ -0,0 +1,514 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *
+ *              C E D A R
+ *          S O L U T I O N S       "Software done right."
+ *           S O F T W A R E
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *
+ * Copyright (c) 2000-2004,2007,2013,2014,2020,2024 Kenneth J. Pronovici.
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License,
+ * Version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Copies of the GNU General Public License are available from
+ * the Free Software Foundation website, http://www.gnu.org/.
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *
+ * Author   : Kenneth J. Pronovici <pronovic@ieee.org>
+ * Language : ANSI C
+ * Project  : banner
+ * Purpose  : Cache of rendered banners.
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/********************
+  File documentation
+ ********************/
+
+/** @file
+  * @author Kenneth J. Pronovici
+  * @brief  Cache of rendered banners.
+  *
+  * The cache is a hash table of entries, chained through each bucket, with
+  * all of the entries also kept on a list from most to least recently used.
+  * Each entry is a single allocation holding the entry itself, its key and
+  * the rendered banner, so the memory used by an entry is easy to account for.
+  *
+  * The key is the font plus the characters the font defines the letters for,
+  * for just the letters that fit.  Two strings with the same key always
+  * render to the same banner, whatever width they were rendered at.  ASCII
+  * characters take one byte of the key, and anything else takes three: a
+  * 0x80 byte that no ASCII character can be mistaken for, and then the
+  * character's code point, high byte first.
+  */
+
+
+/****************
+  Included files
+ ****************/
+
+#include "config.h"
+
+#ifdef HAVE_STDLIB_H
+   #include <stdlib.h>
+#endif
+
+#ifdef HAVE_STRING_H
+   #include <string.h>
+#endif
+
+#include "libbanner.h"
+#include "font.h"
+
+
+/******************
+  Macro defintions
+ *******************/
+
+/** Initial number of hash buckets; always a power of two */
+#define INITIAL_BUCKETS    (64)
+
+
+/******************
+  Type definitions
+ ******************/
+
+/** One cached banner.  The key and then the banner follow it in memory. */
+typedef struct cache_entry
+{
+   struct cache_entry *chain;   /**< Next entry in the same hash bucket */
+   struct cache_entry *newer;   /**< Next more recently used entry */
+   struct cache_entry *older;   /**< Next less recently used entry */
+   unsigned long hash;          /**< Hash of the font and key */
+   const banner_font_t *font;   /**< Font the banner was drawn in */
+   size_t keylength;            /**< Length of the key */
+   size_t size;                 /**< Size of the rendered banner */
+} cache_entry_t;
+
+/** A cache of rendered banners. */
+struct banner_cache
+{
+   cache_entry_t **buckets;     /**< Hash buckets */
+   unsigned long bucketcount;   /**< Number of hash buckets */
+   cache_entry_t *newest;       /**< Most recently used entry */
+   cache_entry_t *oldest;       /**< Least recently used entry */
+   char *scratch;               /**< Key being looked up, or a banner too big to cache */
+   size_t scratchsize;          /**< Number of bytes allocated at scratch */
+   banner_cache_stats_t stats;  /**< Counters, and memory used */
+};
+
+
+/**********************
+  entry_key subroutine
+ **********************/
+/** Returns the key stored in a cache entry.
+  * @param entry     Cache entry
+  * @return Key of the entry.
+  */
+
+static char *entry_key(cache_entry_t *entry)
+{
+   return((char *)(entry + 1));
+}
+
+
+/***********************
+  entry_size subroutine
+ ***********************/
+/** Returns the memory used by a cache entry.
+  * @param entry     Cache entry
+  * @return Size of the entry's allocation, in bytes.
+  */
+
+static size_t entry_size(const cache_entry_t *entry)
+{
+   return(sizeof(cache_entry_t) + entry->keylength + entry->size);
+}
+
+
+/*********************
+  hash_key subroutine
+ *********************/
+/** Hashes a font and key (FNV-1a).
+  * @param font      Font the banner is drawn in
+  * @param key       Key to hash
+  * @param length    Length of the key
+  * @return Hash of the font and key.
+  */
+
+static unsigned long hash_key(const banner_font_t *font, const char *key, size_t length)
+{
+   unsigned long hash = 2166136261UL;
+   size_t i = 0;
+
+   hash ^= (unsigned long)(size_t)font;
+   for(i=0; i<length; i++)
+   {
+      hash ^= (unsigned char)key[i];
+      hash *= 16777619UL;
+   }
+
+   return(hash);
+}
+
+
+/*************************
+  unlink_entry subroutine
+ *************************/
+/** Takes an entry off the recently-used list.
+  * @param cache     Cache the entry is in
+  * @param entry     Entry to take off the list
+  */
+
+static void unlink_entry(banner_cache_t *cache, cache_entry_t *entry)
+{
+   if(entry->newer != NULL)
+   {
+      entry->newer->older = entry->older;
+   }
+   else
+   {
+      cache->newest = entry->older;
+   }
+
+   if(entry->older != NULL)
+   {
+      entry->older->newer = entry->newer;
+   }
+   else
+   {
+      cache->oldest = entry->newer;
+   }
+}
+
+
+/***********************
+  push_entry subroutine
+ ***********************/
+/** Puts an entry at the most recently used end of the list.
+  * @param cache     Cache the entry is in
+  * @param entry     Entry to put on the list
+  */
+
+static void push_entry(banner_cache_t *cache, cache_entry_t *entry)
+{
+   entry->newer = NULL;
+   entry->older = cache->newest;
+   if(cache->newest != NULL)
+   {
+      cache->newest->newer = entry;
+   }
+   else
+   {
+      cache->oldest = entry;
+   }
+   cache->newest = entry;
+}
+
+
+/*************************
+  evict_oldest subroutine
+ *************************/
+/** Drops the least recently used entry from the cache.
+  * @param cache     Cache to drop an entry from
+  */
+
+static void evict_oldest(banner_cache_t *cache)
+{
+   cache_entry_t *entry = cache->oldest;
+   cache_entry_t **link = NULL;
+
+   unlink_entry(cache, entry);
+
+   link = &cache->buckets[entry->hash & (cache->bucketcount - 1)];
+   while(*link != entry)
+   {
+      link = &(*link)->chain;
+   }
+   *link = entry->chain;
+
+   cache->stats.bytes -= entry_size(entry);
+   cache->stats.entries--;
+   cache->stats.evictions++;
+   free(entry);
+}
+
+
+/*************************
+  grow_buckets subroutine
+ *************************/
+/** Doubles the number of hash buckets, rehashing every entry.
+  * If there isn't enough memory, the cache just keeps its longer chains.
+  * @param cache     Cache to grow
+  */
+
+static void grow_buckets(banner_cache_t *cache)
+{
+   cache_entry_t **buckets = NULL;
+   cache_entry_t *entry = NULL;
+   unsigned long count = cache->bucketcount*2;
+   unsigned long i = 0;
+
+   buckets = (cache_entry_t **)calloc(count, sizeof(cache_entry_t *));
+   if(buckets == NULL)
+   {
+      return;
+   }
+   cache->stats.allocations++;
+   cache->stats.allocated += count*sizeof(cache_entry_t *);
+
+   for(entry=cache->newest; entry!=NULL; entry=entry->older)
+   {
+      i = entry->hash & (count - 1);
+      entry->chain = buckets[i];
+      buckets[i] = entry;
+   }
+
+   free(cache->buckets);
+   cache->buckets = buckets;
+   cache->bucketcount = count;
+}
+
+
+/*************************
+  grow_scratch subroutine
+ *************************/
+/** Makes sure the scratch buffer has room for a certain number of bytes.
+  * @param cache     Cache to grow the scratch buffer of
+  * @param needed    Number of bytes needed
+  * @return Boolean true (1) if there is room, boolean false (0) otherwise.
+  */
+
+static int grow_scratch(banner_cache_t *cache, size_t needed)
+{
+   char *scratch = NULL;
+
+   if(needed <= cache->scratchsize)
+   {
+      return(1);
+   }
+
+   scratch = (char *)realloc(cache->scratch, needed);
+   if(scratch == NULL)
+   {
+      return(0);
+   }
+
+   cache->scratch = scratch;
+   cache->scratchsize = needed;
+   cache->stats.allocations++;
+   cache->stats.allocated += needed;
+   return(1);
+}
+
+
+/********************************
+  banner_cache_create subroutine
+ ********************************/
+/** Creates an empty cache of rendered banners.
+  * @param limit     Limit on the memory used by the cache, in bytes
+  * @return New cache, or NULL if there wasn't enough memory.
+  */
+
+banner_cache_t *banner_cache_create(size_t limit)
+{
+   banner_cache_t *cache = NULL;
+
+   cache = (banner_cache_t *)calloc(1, sizeof(banner_cache_t));
+   if(cache == NULL)
+   {
+      return(NULL);
+   }
+
+   cache->bucketcount = INITIAL_BUCKETS;
+   cache->buckets = (cache_entry_t **)calloc(cache->bucketcount, sizeof(cache_entry_t *));
+   if(cache->buckets == NULL)
+   {
+      free(cache);
+      return(NULL);
+   }
+
+   cache->stats.limit = limit;
+   cache->stats.allocations = 2;
+   cache->stats.allocated = sizeof(banner_cache_t) + cache->bucketcount*sizeof(cache_entry_t *);
+   return(cache);
+}
+
+
+/*********************************
+  banner_cache_destroy subroutine
+ *********************************/
+/** Frees a cache created by banner_cache_create(), and everything in it.
+  * @param cache     Cache to free, which may be NULL
+  */
+
+void banner_cache_destroy(banner_cache_t *cache)
+{
+   cache_entry_t *entry = NULL;
+   cache_entry_t *older = NULL;
+
+   if(cache == NULL)
+   {
+      return;
+   }
+
+   for(entry=cache->newest; entry!=NULL; entry=older)
+   {
+      older = entry->older;
+      free(entry);
+   }
+
+   free(cache->buckets);
+   free(cache->scratch);
+   free(cache);
+}
+
+
+/********************************
+  banner_cache_render subroutine
+ ********************************/
+/** Returns a rendered banner, from the cache if possible.
+  * @param cache     Cache to look in
+  * @param font      Font to draw the banner in
+  * @param string    String to be rendered, which need not be null-terminated
+  * @param length    Length of the string
+  * @param maxwidth  Maximum width of any one banner line, as for banner_measure()
+  * @param metrics   Returns the dimensions of the banner, as from banner_measure()
+  * @return Rendered banner, which is valid until the cache is next used, or
+  *         NULL if there wasn't enough memory to render it.
+  */
+
+const char *banner_cache_render(banner_cache_t *cache, const banner_font_t *font,
+                                const char *string, size_t length, int maxwidth, banner_metrics_t *metrics)
+{
+   cache_entry_t *entry = NULL;
+   const glyph_t *glyph = NULL;
+   unsigned long hash = 0;
+   size_t keylength = 0;
+   size_t j = 0;
+   unsigned char c = 0;
+   int32_t code = 0;
+   char *banner = NULL;
+
+   banner_measure(font, string, length, maxwidth, metrics);
+
+   /* Build the key in the scratch buffer */
+   if(!grow_scratch(cache, 3*metrics->consumed + 1))
+   {
+      return(NULL);
+   }
+
+   j = 0;
+   while(j < metrics->consumed)
+   {
+      c = (unsigned char)string[j];
+      if(c < 0x80)
+      {
+         glyph = &font->glyphs[c];
+         j++;
+      }
+      else
+      {
+         code = banner_decode(string, metrics->consumed, &j);
+         glyph = FONT_GLYPH(font, code);
+      }
+
+      if(glyph->present)
+      {
+         if(glyph->code < 0x80)
+         {
+            cache->scratch[keylength++] = (char)glyph->code;
+         }
+         else
+         {
+            cache->scratch[keylength++] = (char)0x80;
+            cache->scratch[keylength++] = (char)(glyph->code >> 8);
+            cache->scratch[keylength++] = (char)(glyph->code & 0xFF);
+         }
+      }
+   }
+
+   hash = hash_key(font, cache->scratch, keylength);
+
+   for(entry=cache->buckets[hash & (cache->bucketcount - 1)]; entry!=NULL; entry=entry->chain)
+   {
+      if(entry->hash == hash && entry->font == font && entry->keylength == keylength &&
+         memcmp(entry_key(entry), cache->scratch, keylength) == 0)
+      {
+         cache->stats.hits++;
+         unlink_entry(cache, entry);
+         push_entry(cache, entry);
+         return(entry_key(entry) + entry->keylength);
+      }
+   }
+
+   cache->stats.misses++;
+
+   /* Banners too big to ever fit are rendered into the scratch buffer instead */
+   if(sizeof(cache_entry_t) + keylength + metrics->size > cache->stats.limit)
+   {
+      if(!grow_scratch(cache, metrics->size))
+      {
+         return(NULL);
+      }
+      banner_render(font, string, metrics, cache->scratch, metrics->size);
+      return(cache->scratch);
+   }
+
+   entry = (cache_entry_t *)malloc(sizeof(cache_entry_t) + keylength + metrics->size);
+   if(entry == NULL)
+   {
+      return(NULL);
+   }
+   cache->stats.allocations++;
+   cache->stats.allocated += sizeof(cache_entry_t) + keylength + metrics->size;
+
+   entry->hash = hash;
+   entry->font = font;
+   entry->keylength = keylength;
+   entry->size = metrics->size;
+   memcpy(entry_key(entry), cache->scratch, keylength);
+   banner = entry_key(entry) + keylength;
+   banner_render(font, string, metrics, banner, metrics->size);
+
+   while(cache->stats.bytes + entry_size(entry) > cache->stats.limit)
+   {
+      evict_oldest(cache);
+   }
+
+   if(cache->stats.entries >= cache->bucketcount)
+   {
+      grow_buckets(cache);
+   }
+
+   entry->chain = cache->buckets[hash & (cache->bucketcount - 1)];
+   cache->buckets[hash & (cache->bucketcount - 1)] = entry;
+   push_entry(cache, entry);
+   cache->stats.bytes += entry_size(entry);
+   cache->stats.entries++;
+
+   return(banner);
+}
+
+
+/*******************************
+  banner_cache_stats subroutine
+ *******************************/
+/** Returns the counters for a cache.
+  * @param cache     Cache to report on
+  * @param stats     Returns the counters
+  */
+
+void banner_cache_stats(const banner_cache_t *cache, banner_cache_stats_t *stats)
+{
+   *stats = cache->stats;
+}
+
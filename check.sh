@@ -0,0 +1,279 @@
+#!/bin/sh
+# # # # # # # # # # # # # # # # # # # # # # # # # # # # # # # # # # #
+#
+#              C E D A R
+#          S O L U T I O N S       "Software done right."
+#           S O F T W A R E
+#
+# # # # # # # # # # # # # # # # # # # # # # # # # # # # # # # # # # #
+#
+# Copyright (c) 2000-2004,2007,2013,2014,2020,2024 Kenneth J. Pronovici.
+# All rights reserved.
+#
+# This program is free software; you can redistribute it and/or
+# modify it under the terms of the GNU General Public License,
+# Version 2, as published by the Free Software Foundation.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+#
+# Copies of the GNU General Public License are available from
+# the Free Software Foundation website, http://www.gnu.org/.
+#
+# # # # # # # # # # # # # # # # # # # # # # # # # # # # # # # # # # #
+#
+# Author   : Kenneth J. Pronovici <pronovic@ieee.org>
+# Language : Bourne shell
+# Project  : banner
+# Purpose  : Regression tests, run by "make check".
+#
+# # # # # # # # # # # # # # # # # # # # # # # # # # # # # # # # # # #
+
+# Each rendering case appends its output, any error message (without the
+# program name) and its exit status to a log, which has to match
+# check.expected exactly.  After a deliberate change to the output, the
+# log can be copied over check.expected, once it's been looked over.
+# Banners drawn by a render daemon are compared against the same banners
+# drawn by banner itself.
+#
+# Damaged fonts, malformed font sources and bad options aren't compared
+# against anything; banner and banner-fontc just have to refuse them with
+# their usual error status, rather than crash or carry on.
+
+srcdir=${srcdir:-.}
+BANNER=./banner
+FONTC=./banner-fontc
+work=check.tmp
+failed=0
+
+COLUMNS=80
+LC_ALL=C
+export COLUMNS LC_ALL
+
+rm -rf $work
+mkdir $work || exit 1
+trap 'rm -rf $work' 0
+
+fail()
+{
+   echo "FAIL: $*"
+   failed=1
+}
+
+# run name command...
+run()
+{
+   echo "== $1" >> $work/actual
+   shift
+   "$@" >> $work/actual 2> $work/err
+   status=$?
+   sed 's/^[^:]*: //' $work/err >> $work/actual
+   echo "status $status" >> $work/actual
+}
+
+# refuse name command...
+refuse()
+{
+   name=$1
+   shift
+   "$@" > /dev/null 2>&1
+   status=$?
+   if test $status -ne 255; then
+      fail "$name (status $status)"
+   fi
+}
+
+# survive name command...
+survive()
+{
+   name=$1
+   shift
+   "$@" > /dev/null 2>&1
+   status=$?
+   if test $status -ne 0 && test $status -ne 255; then
+      fail "$name (status $status)"
+   fi
+}
+
+# damage offset bytes: copies the font, then writes over it at offset
+damage()
+{
+   cp $work/font.bf $work/bad.bf
+   printf "$2" | dd of=$work/bad.bf bs=1 seek=$1 conv=notrunc 2> /dev/null
+}
+
+# shorten length: copies the start of the font
+shorten()
+{
+   dd if=$work/font.bf of=$work/bad.bf bs=1 count=$1 2> /dev/null
+}
+
+# visible command...: runs a command, with the escape sequences it writes
+# made visible, and a newline after the last of them
+visible()
+{
+   "$@" > $work/raw
+   status=$?
+   cat -v $work/raw
+   echo
+   return $status
+}
+
+# Rendering
+run "plain" $BANNER "Hello, World!"
+run "several words" $BANNER one two
+run "case folding" $BANNER hello
+printf 'one\r\ntwo\n\nthree' > $work/lines
+run "stdin" $BANNER - < $work/lines
+run "file" $BANNER --file $work/lines
+run "file with jobs" $BANNER --jobs 3 --file $work/lines
+run "cache" $BANNER --cache 64 one two one
+run "not a font" $BANNER --font $work/lines A
+$FONTC $srcdir/check.flf $work/figlet.bf
+run "FIGlet font" $BANNER --font $work/figlet.bf '! "#'
+run "wrap" env COLUMNS=40 $BANNER --wrap "The quick brown fox"
+run "wrap too narrow" env COLUMNS=3 $BANNER --wrap ABCDEF
+run "truncated" env COLUMNS=20 $BANNER --warn abcdefgh
+run "trailing whitespace" env COLUMNS=20 $BANNER --warn "ab      "
+
+# --stats, with the timings and the allocations (which depend on the
+# platform) masked
+printf 'one\ntwo\none\n' > $work/repeats
+$BANNER --stats - < $work/repeats > /dev/null 2> $work/stats
+status=$?
+mask=
+for key in allocations allocated_bytes parse width measure render output; do
+   mask="$mask -e s/\"$key\":[0-9]*/\"$key\":N/"
+done
+echo "== stats" >> $work/actual
+sed $mask $work/stats >> $work/actual
+echo "status $status" >> $work/actual
+
+run "scale" $BANNER --scale 2x1 AB
+run "vertical" $BANNER --vertical AB
+run "marquee" env COLUMNS=20 $BANNER --marquee --rate 1000 --frames 3 AB
+run "marquee changes" visible env COLUMNS=20 $BANNER --marquee --rate 1000 --step 2 --frames 4 ABC
+run "clock" visible env COLUMNS=40 $BANNER --clock 12:34 --frames 1
+run "color" $BANNER --color letters --colors ff0000,0000ff AB
+
+# A null drawn by a font that defines it takes the next color, like any letter
+printf 'height 1\nspace 1\nglyph A\n|A|\nglyph 0x0\n|N|\n' > $work/null.txt
+$FONTC $work/null.txt $work/null.bf
+printf 'A\000A\n' > $work/null
+run "color with a null" visible $BANNER --font $work/null.bf --color letters --colors ff0000,0000ff - < $work/null
+
+# Lower-case letters beyond ASCII, in a font that has their upper case
+printf 'height 1\nspace 1\nglyph I\n|I|\nglyph 0x130\n|D|\nglyph 0x100\n|A|\nglyph 0x132\n|J|\n' > $work/fold.txt
+$FONTC $work/fold.txt $work/fold.bf
+run "case folding beyond ASCII" $BANNER --font $work/fold.bf "`printf '\304\201\304\261i\304\260\304\263'`"
+
+# Invalid UTF-8: a stray continuation byte, an overlong encoding, a
+# surrogate, a character past U+10FFFF and a cut-off sequence
+bad=`printf 'A\200B\300\200C\355\240\200D\364\220\200\200E\342\202'`
+run "invalid UTF-8" $BANNER "$bad"
+printf '%s\n' "$bad" > $work/utf8
+run "invalid UTF-8 on stdin" $BANNER - < $work/utf8
+run "invalid UTF-8 wrapped" env COLUMNS=30 $BANNER --wrap "$bad"
+run "invalid UTF-8 vertical" $BANNER --vertical "$bad"
+
+if cmp -s $srcdir/check.expected $work/actual; then
+   :
+else
+   fail "output differs from check.expected"
+   diff $srcdir/check.expected $work/actual
+fi
+
+# A render daemon draws the same banners as banner does on its own
+$BANNER --serve $work/socket 2> /dev/null &
+server=$!
+tries=0
+while test ! -S $work/socket && test $tries -lt 10; do
+   sleep 1
+   tries=`expr $tries + 1`
+done
+if test -S $work/socket; then
+   $BANNER "Hello, World!" one two > $work/local
+   $BANNER --client $work/socket "Hello, World!" one two > $work/served 2>&1
+   cmp -s $work/local $work/served || fail "--client draws differently from argv"
+   $BANNER - < $work/lines > $work/local
+   $BANNER --client $work/socket - < $work/lines > $work/served 2>&1
+   cmp -s $work/local $work/served || fail "--client draws differently from stdin"
+else
+   fail "--serve never opened its socket"
+fi
+kill $server 2> /dev/null
+wait $server
+test -S $work/socket && fail "--serve left its socket behind"
+
+# Compiled fonts draw just like the built-in one
+if $FONTC $srcdir/letters.h $work/font.bf; then
+   $BANNER "Hello, World!" > $work/builtin
+   $BANNER --font $work/font.bf "Hello, World!" > $work/compiled
+   cmp -s $work/builtin $work/compiled || fail "compiled letters.h draws differently"
+
+   # Damaged headers
+   damage 0 'X';                   refuse "bad magic" $BANNER --font $work/bad.bf A
+   damage 12 '\377\377\377\177';   refuse "bad version" $BANNER --font $work/bad.bf A
+   damage 16 '\0\0\0\0';           refuse "zero height" $BANNER --font $work/bad.bf A
+   damage 16 '\377\377\377\177';   refuse "huge height" $BANNER --font $work/bad.bf A
+   damage 20 '\377\377\377\177';   refuse "huge space" $BANNER --font $work/bad.bf A
+   damage 24 '\377\377\377\177';   refuse "huge stride" $BANNER --font $work/bad.bf A
+   damage 28 '\377\377\377\177';   refuse "huge words" $BANNER --font $work/bad.bf A
+   damage 32 '\377\377\377\177';   refuse "bad fill" $BANNER --font $work/bad.bf A
+   damage 40 '\377\377\377\177';   refuse "too many pages" $BANNER --font $work/bad.bf A
+   damage 44 '\377\377\377\177';   refuse "glyphs past the end" $BANNER --font $work/bad.bf A
+   damage 48 '\377\377\377\177';   refuse "directory past the end" $BANNER --font $work/bad.bf A
+   damage 60 '\377\377\377\177';   refuse "wrong size" $BANNER --font $work/bad.bf A
+
+   # Truncated files
+   size=`wc -c < $work/font.bf`
+   for length in 0 7 8 63 64 `expr $size / 2` `expr $size - 1`; do
+      shorten $length
+      refuse "truncated to $length bytes" $BANNER --font $work/bad.bf A
+   done
+
+   # Any damaged byte, anywhere in the file
+   offset=0
+   while test $offset -lt $size; do
+      damage $offset '\377'
+      survive "damaged at $offset" $BANNER --font $work/bad.bf "Hello, World!"
+      if test $offset -lt 64; then
+         offset=`expr $offset + 1`
+      else
+         offset=`expr $offset + 61`
+      fi
+   done
+else
+   fail "banner-fontc letters.h"
+fi
+
+# Malformed FIGlet fonts
+sed '1s/.*/flf2a/' $srcdir/check.flf > $work/bad.flf
+refuse "FIGlet header without a hardblank" $FONTC $work/bad.flf $work/bad.bf
+sed '1s/.*/flf2a$ 3 2/' $srcdir/check.flf > $work/bad.flf
+refuse "FIGlet header too short" $FONTC $work/bad.flf $work/bad.bf
+sed '1s/.*/flf2a$ 0 2 5 0 3/' $srcdir/check.flf > $work/bad.flf
+refuse "FIGlet font with no height" $FONTC $work/bad.flf $work/bad.bf
+sed '1s/ 3$/ 30/' $srcdir/check.flf > $work/bad.flf
+refuse "FIGlet font ending in its comments" $FONTC $work/bad.flf $work/bad.bf
+sed '$d' $srcdir/check.flf > $work/bad.flf
+refuse "FIGlet character cut short" $FONTC $work/bad.flf $work/bad.bf
+
+# Missing fonts and bad options
+refuse "missing font" $BANNER --font $work/missing.bf A
+refuse "bad --jobs" $BANNER --jobs 4x A
+refuse "bad --cache" $BANNER --cache 64k A
+refuse "negative --cache" $BANNER --cache -1 A
+refuse "huge --cache" $BANNER --cache 1048577 A
+refuse "bad --flush" $BANNER --flush 1.5 A
+refuse "huge --flush" $BANNER --flush 65537 A
+refuse "--file without a path" $BANNER --file
+refuse "bad --rate" $BANNER --marquee --rate 0 A
+refuse "huge --rate" $BANNER --marquee --rate 1001 A
+refuse "bad --step" $BANNER --marquee --step 2x A
+refuse "bad --frames" $BANNER --marquee --frames 0 A
+refuse "huge --frames" $BANNER --marquee --frames 99999999999999999999 A
+refuse "bad --colors" $BANNER --color letters --colors 0x1234 A
+
+exit $failed
@@ -0,0 +1,497 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *
+ *              C E D A R
+ *          S O L U T I O N S       "Software done right."
+ *           S O F T W A R E
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *
+ * Copyright (c) 2000-2004,2007,2013,2014,2020,2024 Kenneth J. Pronovici.
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License,
+ * Version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Copies of the GNU General Public License are available from
+ * the Free Software Foundation website, http://www.gnu.org/.
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *
+ * Author   : Kenneth J. Pronovici <pronovic@ieee.org>
+ * Language : ANSI C
+ * Project  : banner
+ * Purpose  : ANSI color for --color, laid over rendered banners.
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/********************
+  File documentation
+ ********************/
+
+/** @file
+  * @author Kenneth J. Pronovici
+  * @brief  ANSI color for --color, laid over rendered banners.
+  *
+  * Coloring every character on its own would put an escape sequence in
+  * front of each of them, and make a banner many times bigger.  Instead, an
+  * escape sequence is only written where the color actually changes, and
+  * spaces (which look the same whatever the color) never change it, so a
+  * letter's color carries across the gap to the next letter if that's the
+  * same color too.  Each line that was colored is reset at its end, so that
+  * the color never leaks out of the banner.
+  *
+  * Every escape sequence a scheme can use is formatted once, when it's set
+  * up, and then just copied.  A gradient is cut into a fixed number of
+  * steps, and steps that come out the same color share one sequence, which
+  * counts for a lot with 256 colors.  Each banner is cut into runs of
+  * columns that are the same color, once, so coloring a line is a quick
+  * check of each run for anything but spaces, eight bytes at a time, and
+  * copying the characters between changes of color as they are.
+  */
+
+
+/****************
+  Included files
+ ****************/
+
+#include "config.h"
+
+#include <stdio.h>
+
+#ifdef HAVE_STDLIB_H
+   #include <stdlib.h>
+#endif
+
+#ifdef HAVE_STRING_H
+   #include <string.h>
+#endif
+
+#include <errno.h>
+#include <limits.h>
+#include <stdint.h>
+
+#include "libbanner.h"
+#include "color.h"
+
+
+/******************
+  Macro defintions
+ *******************/
+
+/** Most colors in a list */
+#define COLOR_MAX_COLORS   (16)
+
+/** Number of steps a gradient is cut into */
+#define COLOR_STEPS        (32)
+
+/** Longest escape sequence, including its terminating null */
+#define COLOR_ESCAPE_SIZE  (24)
+
+/** Escape sequence that goes back to the terminal's own colors */
+#define COLOR_RESET        ("\033[0m")
+
+
+/******************
+  Type definitions
+ ******************/
+
+/** A color scheme, with its escape sequences formatted. */
+struct color
+{
+   color_mode_t mode;                              /**< How colors are laid over each banner */
+   int count;                                      /**< Number of escape sequences */
+   int longest;                                    /**< Length of the longest escape sequence */
+   unsigned char steps[COLOR_STEPS];               /**< Escape sequence for each step of a gradient */
+   char escapes[COLOR_STEPS][COLOR_ESCAPE_SIZE];   /**< Escape sequences */
+   int lengths[COLOR_STEPS];                       /**< Length of each escape sequence */
+};
+
+
+/*************************
+  parse_colors subroutine
+ *************************/
+/** Parses a comma-separated list of colors.
+  * @param colors    List of colors, each as six hex digits, maybe after a '#'
+  * @param rgb       Returns the red, green and blue of each color
+  * @return Number of colors, or zero if the list is no good.
+  */
+
+static int parse_colors(const char *colors, int rgb[][3])
+{
+   unsigned long value = 0;
+   char *end = NULL;
+   int count = 0;
+
+   for(;;)
+   {
+      colors += *colors == '#';
+      if(strspn(colors, "0123456789abcdefABCDEF") != 6 || count == COLOR_MAX_COLORS)
+      {
+         return(0);
+      }
+
+      value = strtoul(colors, &end, 16);
+
+      rgb[count][0] = (int)(value >> 16) & 0xFF;
+      rgb[count][1] = (int)(value >> 8) & 0xFF;
+      rgb[count][2] = (int)value & 0xFF;
+      count++;
+
+      if(*end == '\0')
+      {
+         return(count);
+      }
+      if(*end != ',')
+      {
+         return(0);
+      }
+      colors = end + 1;
+   }
+}
+
+
+/**************************
+  format_escape subroutine
+ **************************/
+/** Formats the escape sequence for a color as the scheme's next one.
+  * The sequence isn't counted; the caller decides whether to keep it.
+  * @param color     Color scheme to add to
+  * @param rgb       Red, green and blue of the color
+  * @param truecolor Boolean true (1) for a 24-bit escape sequence, false (0) for 256 colors
+  * @return The escape sequence.
+  */
+
+static const char *format_escape(color_t *color, const int *rgb, int truecolor)
+{
+   char *escape = color->escapes[color->count];
+
+   if(truecolor)
+   {
+      sprintf(escape, "\033[38;2;%d;%d;%dm", rgb[0], rgb[1], rgb[2]);
+   }
+   else
+   {
+      sprintf(escape, "\033[38;5;%dm", 16 + 36*((rgb[0]*5 + 127)/255) + 6*((rgb[1]*5 + 127)/255) + (rgb[2]*5 + 127)/255);
+   }
+
+   color->lengths[color->count] = (int)strlen(escape);
+   if(color->lengths[color->count] > color->longest)
+   {
+      color->longest = color->lengths[color->count];
+   }
+
+   return(escape);
+}
+
+
+/*************************
+  color_create subroutine
+ *************************/
+/** Sets up a color scheme.
+  * Each color in the list gets an escape sequence for the letters.  For a
+  * gradient, each step is shaded between the two colors in the list on
+  * either side of it, and gets the last step's sequence if that's the same.
+  * @param mode      How colors are laid over each banner
+  * @param colors    Comma-separated list of colors
+  * @param truecolor Boolean true (1) for 24-bit escape sequences, false (0) for 256 colors
+  * @return Color scheme, or NULL with errno set.
+  */
+
+color_t *color_create(color_mode_t mode, const char *colors, int truecolor)
+{
+   color_t *color = NULL;
+   const char *escape = NULL;
+   int rgb[COLOR_MAX_COLORS][3];
+   int shade[3];
+   int count = 0;
+   int low = 0;
+   int part = 0;
+   int i = 0;
+   int j = 0;
+
+   count = parse_colors(colors, rgb);
+   if(count == 0)
+   {
+      errno = EINVAL;
+      return(NULL);
+   }
+
+   color = (color_t *)calloc(1, sizeof(color_t));
+   if(color == NULL)
+   {
+      errno = ENOMEM;
+      return(NULL);
+   }
+
+   color->mode = mode;
+   if(mode == COLOR_LETTERS)
+   {
+      for(color->count=0; color->count<count; color->count++)
+      {
+         format_escape(color, rgb[color->count], truecolor);
+      }
+      return(color);
+   }
+
+   for(i=0; i<COLOR_STEPS; i++)
+   {
+      low = i*(count - 1)/(COLOR_STEPS - 1);
+      low = low < count - 1 ? low : count > 1 ? count - 2 : 0;
+      part = i*(count - 1) - low*(COLOR_STEPS - 1);   /* how far past low, in steps */
+      for(j=0; j<3; j++)
+      {
+         shade[j] = count > 1 ? rgb[low][j] + (rgb[low + 1][j] - rgb[low][j])*part/(COLOR_STEPS - 1) : rgb[0][j];
+      }
+
+      escape = format_escape(color, shade, truecolor);
+      if(color->count > 0 && strcmp(escape, color->escapes[color->count - 1]) == 0)
+      {
+         color->steps[i] = (unsigned char)(color->count - 1);   /* same as the last step */
+      }
+      else
+      {
+         color->steps[i] = (unsigned char)color->count++;
+      }
+   }
+
+   return(color);
+}
+
+
+/************************
+  color_bound subroutine
+ ************************/
+/** Works out the most that color_banner() can write for a banner.
+  * Each line can change color at most once for each column, and for each
+  * escape sequence in a gradient across it, or once for each character if
+  * the letters are colored.
+  * @param color     Color scheme
+  * @param metrics   Dimensions of the banner
+  * @return Size of the colored banner at most, in bytes.
+  */
+
+size_t color_bound(const color_t *color, const banner_metrics_t *metrics)
+{
+   size_t changes = 0;
+
+   switch(color->mode)
+   {
+      case COLOR_LETTERS:
+         changes = metrics->consumed;
+         break;
+      case COLOR_HORIZONTAL:
+         changes = color->count;
+         break;
+      default:
+         changes = 1;
+         break;
+   }
+
+   if(changes > (size_t)metrics->width)
+   {
+      changes = metrics->width;
+   }
+
+   return(metrics->size + metrics->height*(changes*color->longest + strlen(COLOR_RESET)));
+}
+
+
+/**********************
+  fill_runs subroutine
+ **********************/
+/** Works out where each color starts across a banner.
+  * For the letters, each character is measured on its own to find the
+  * columns it covers, which add up to the same as the banner as a whole.
+  * Whitespace doesn't use up a color, so the colors run on across words.
+  * @param color     Color scheme
+  * @param font      Font the banner was drawn in
+  * @param string    String the banner was drawn from
+  * @param metrics   Dimensions of the banner
+  * @param runs      Returns the first column of each run, then the end of the last
+  * @param escapes   Returns the escape sequence for each run
+  * @return Number of runs.
+  */
+
+static int fill_runs(const color_t *color, const banner_font_t *font, const char *string,
+                     const banner_metrics_t *metrics, int *runs, int *escapes)
+{
+   banner_metrics_t letter;
+   size_t position = 0;
+   size_t length = 0;
+   int letters = 0;
+   int wanted = 0;
+   int count = 0;
+   int x = 0;
+
+   if(color->mode == COLOR_HORIZONTAL)
+   {
+      for(x=0; x<metrics->width; x++)
+      {
+         wanted = color->steps[metrics->width > 1 ? x*(COLOR_STEPS - 1)/(metrics->width - 1) : 0];
+         if(count == 0 || escapes[count - 1] != wanted)
+         {
+            runs[count] = x;
+            escapes[count++] = wanted;
+         }
+      }
+   }
+   else
+   {
+      for(position=0; position<metrics->consumed && x<metrics->width; position+=length)
+      {
+         for(length=1; position+length < metrics->consumed && ((unsigned char)string[position+length] & 0xC0) == 0x80; length++)
+         {
+            continue;   /* the rest of a UTF-8 character */
+         }
+
+         banner_measure(font, string + position, length, INT_MAX, &letter);
+         if(letter.width > 0)
+         {
+            wanted = letters % color->count;
+            if(count == 0 || escapes[count - 1] != wanted)
+            {
+               runs[count] = x;
+               escapes[count++] = wanted;
+            }
+            x += letter.width;
+            letters += length > 1 || string[position] == '\0' || strchr(" \t\n\v\f\r", string[position]) == NULL;
+         }
+      }
+   }
+
+   runs[count] = metrics->width;
+   return(count);
+}
+
+
+/********************
+  has_ink subroutine
+ ********************/
+/** Checks whether part of a banner line has anything but spaces in it,
+  * eight bytes at a time.
+  * @param line      Part of a line to check
+  * @param length    Length of that part
+  * @return Boolean true (1) if any character isn't a space, boolean false (0) otherwise.
+  */
+
+static int has_ink(const char *line, int length)
+{
+   uint64_t word = 0;
+   int j = 0;
+
+   for(j=0; j+(int)sizeof(word)<=length; j+=sizeof(word))
+   {
+      memcpy(&word, line + j, sizeof(word));
+      if(word != UINT64_C(0x2020202020202020))
+      {
+         return(1);
+      }
+   }
+   for(; j<length; j++)
+   {
+      if(line[j] != ' ')
+      {
+         return(1);
+      }
+   }
+
+   return(0);
+}
+
+
+/*************************
+  color_banner subroutine
+ *************************/
+/** Copies a rendered banner into a buffer, with color.
+  * The banner is cut into runs of columns that are the same color, worked
+  * out once for the banner (or one run per line for a vertical gradient).
+  * An escape sequence goes in front of a run only if it has something other
+  * than spaces in it on that line, and needs a different color from the last
+  * one written; everything else is copied as it is.
+  * @param color     Color scheme
+  * @param font      Font the banner was drawn in
+  * @param string    String the banner was drawn from
+  * @param metrics   Dimensions of the banner
+  * @param plain     Rendered banner
+  * @param scratch   Scratch space of 2*(metrics->width + 2) ints
+  * @param buffer    Buffer to copy into, at least color_bound() bytes long
+  * @return Number of bytes written.
+  */
+
+size_t color_banner(const color_t *color, const banner_font_t *font, const char *string,
+                    const banner_metrics_t *metrics, const char *plain,
+                    int *scratch, char *buffer)
+{
+   const char *line = NULL;
+   char *out = buffer;
+   int *runs = scratch;
+   int *escapes = scratch + metrics->width + 2;
+   int count = 1;
+   int current = 0;
+   int start = 0;
+   int k = 0;
+   int y = 0;
+
+   if(color->mode == COLOR_VERTICAL)
+   {
+      runs[0] = 0;
+      runs[1] = metrics->width;
+   }
+   else
+   {
+      count = fill_runs(color, font, string, metrics, runs, escapes);
+   }
+
+   for(y=0; y<metrics->height; y++)
+   {
+      line = plain + (size_t)y*(metrics->width + 1);
+      if(color->mode == COLOR_VERTICAL)
+      {
+         escapes[0] = color->steps[metrics->height > 1 ? y*(COLOR_STEPS - 1)/(metrics->height - 1) : 0];
+      }
+
+      current = -1;
+      start = 0;
+      for(k=0; k<count; k++)
+      {
+         if(escapes[k] != current && has_ink(line + runs[k], runs[k + 1] - runs[k]))
+         {
+            memcpy(out, line + start, runs[k] - start);
+            out += runs[k] - start;
+            memcpy(out, color->escapes[escapes[k]], color->lengths[escapes[k]]);
+            out += color->lengths[escapes[k]];
+            current = escapes[k];
+            start = runs[k];
+         }
+      }
+
+      memcpy(out, line + start, metrics->width - start);
+      out += metrics->width - start;
+      if(current >= 0)
+      {
+         memcpy(out, COLOR_RESET, strlen(COLOR_RESET));
+         out += strlen(COLOR_RESET);
+      }
+      *out++ = '\n';
+   }
+
+   return(out - buffer);
+}
+
+
+/**************************
+  color_destroy subroutine
+ **************************/
+/** Frees a color scheme.
+  * @param color     Color scheme to free, which may be NULL
+  */
+
+void color_destroy(color_t *color)
+{
+   free(color);
+}
@@ -0,0 +1,120 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *
+ *              C E D A R
+ *          S O L U T I O N S       "Software done right."
+ *           S O F T W A R E
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *
+ * Copyright (c) 2000-2004,2007,2013,2014,2020,2024 Kenneth J. Pronovici.
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License,
+ * Version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Copies of the GNU General Public License are available from
+ * the Free Software Foundation website, http://www.gnu.org/.
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *
+ * Author   : Kenneth J. Pronovici <pronovic@ieee.org>
+ * Language : ANSI C
+ * Project  : banner
+ * Purpose  : ANSI color for --color, laid over rendered banners.
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/********************
+  File documentation
+ ********************/
+
+/** @file
+  * @author Kenneth J. Pronovici
+  * @brief  ANSI color for --color, laid over rendered banners.
+  *
+  * Color is laid over a banner after it has been rendered (or copied from
+  * the cache), so the renderer and the cache never see it.  A color scheme
+  * gives each letter of a banner a color of its own, or shades the banner
+  * from one color to another across its width or down its height, through
+  * a list of colors.  Colors are written as 256-color or 24-bit ("true
+  * color") escape sequences.
+  */
+
+#ifndef COLOR_H
+#define COLOR_H
+/*{*/
+
+#include "libbanner.h"
+
+
+/******************
+  Macro defintions
+ *******************/
+
+/** Default list of colors, as for color_create() */
+#define COLOR_DEFAULT_COLORS  ("ff0000,ff8000,ffff00,00ff00,0080ff,8000ff")
+
+
+/******************
+  Type definitions
+ ******************/
+
+/** How colors are laid over a banner. */
+typedef enum
+{
+   COLOR_LETTERS,       /**< Each letter gets the next color in the list */
+   COLOR_HORIZONTAL,    /**< The colors shade into each other across the banner */
+   COLOR_VERTICAL       /**< The colors shade into each other down the banner */
+} color_mode_t;
+
+/** A color scheme, with its escape sequences formatted.  The contents are private. */
+typedef struct color color_t;
+
+
+/***********************
+  Function declarations
+ ***********************/
+
+/** Sets up a color scheme.
+  * @param mode      How colors are laid over each banner
+  * @param colors    Comma-separated list of colors, each as six hex digits @c RRGGBB
+  * @param truecolor Boolean true (1) for 24-bit escape sequences, false (0) for 256 colors
+  * @return Color scheme, or NULL with errno set (EINVAL if the list is no good).
+  */
+extern color_t *color_create(color_mode_t mode, const char *colors, int truecolor);
+
+/** Works out the most that color_banner() can write for a banner.
+  * @param color     Color scheme
+  * @param metrics   Dimensions of the banner
+  * @return Size of the colored banner at most, in bytes.
+  */
+extern size_t color_bound(const color_t *color, const banner_metrics_t *metrics);
+
+/** Copies a rendered banner into a buffer, with color.
+  * Nothing here changes the color scheme, so any number of threads can color
+  * banners with the same one.
+  * @param color     Color scheme
+  * @param font      Font the banner was drawn in
+  * @param string    String the banner was drawn from
+  * @param metrics   Dimensions of the banner
+  * @param plain     Rendered banner, as from banner_render()
+  * @param scratch   Scratch space of 2*(@c metrics->width + 2) ints
+  * @param buffer    Buffer to copy into, at least color_bound() bytes long
+  * @return Number of bytes written.
+  */
+extern size_t color_banner(const color_t *color, const banner_font_t *font, const char *string,
+                           const banner_metrics_t *metrics, const char *plain,
+                           int *scratch, char *buffer);
+
+/** Frees a color scheme.
+  * @param color     Color scheme to free, which may be NULL
+  */
+extern void color_destroy(color_t *color);
+
+/*}*/
+#endif /* ifndef COLOR_H */
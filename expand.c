@@ -0,0 +1,207 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *
+ *              C E D A R
+ *          S O L U T I O N S       "Software done right."
+ *           S O F T W A R E
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *
+ * Copyright (c) 2000-2004,2007,2013,2014,2020,2024 Kenneth J. Pronovici.
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License,
+ * Version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Copies of the GNU General Public License are available from
+ * the Free Software Foundation website, http://www.gnu.org/.
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *
+ * Author   : Kenneth J. Pronovici <pronovic@ieee.org>
+ * Language : ANSI C
+ * Project  : banner
+ * Purpose  : Kernels that expand glyph bitmaps into characters.
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/********************
+  File documentation
+ ********************/
+
+/** @file
+  * @author Kenneth J. Pronovici
+  * @brief  Kernels that expand glyph bitmaps into characters.
+  *
+  * The vector kernels all work the same way.  Each byte of the bits is copied
+  * into the eight lanes that its bits belong to, and each lane is then masked
+  * with the one bit it stands for.  Comparing that against the bit gives an
+  * all-ones lane for a set bit, which selects between the fill and blank
+  * characters.  That's 16 characters per step with SSE2, and 32 with AVX2.
+  * A last, partial step is stored aside and only the characters that were
+  * asked for are copied out, so nothing past the end of @c out is touched.
+  *
+  * The vector kernels are compiled for their instruction sets function by
+  * function, so the rest of the library still runs on any processor, and
+  * banner_choose_expander() only hands them out once it has checked that the
+  * processor has the instructions.
+  */
+
+
+/****************
+  Included files
+ ****************/
+
+#include "config.h"
+
+#ifdef HAVE_STRING_H
+   #include <string.h>
+#endif
+
+#ifdef HAVE_CPU_DISPATCH
+   #include <immintrin.h>
+#endif
+
+#include "expand.h"
+
+
+/*************************
+  expand_plain subroutine
+ *************************/
+/** Expands bits into characters one at a time, on any processor.
+  * @param out       Where to write the characters
+  * @param bits      Bits to expand, lowest (leftmost) first
+  * @param count     Number of bits to expand
+  * @param fill      Character written for a set bit
+  * @param blank     Character written for a clear bit
+  */
+
+static void expand_plain(char *out, uint64_t bits, int count, char fill, char blank)
+{
+   int i = 0;
+
+   for(i=0; i<count; i++)
+   {
+      out[i] = (bits >> i) & 1 ? fill : blank;
+   }
+}
+
+
+#ifdef HAVE_CPU_DISPATCH
+
+/************************
+  expand_sse2 subroutine
+ ************************/
+/** Expands bits into characters 16 at a time, using SSE2.
+  * @param out       Where to write the characters
+  * @param bits      Bits to expand, lowest (leftmost) first
+  * @param count     Number of bits to expand
+  * @param fill      Character written for a set bit
+  * @param blank     Character written for a clear bit
+  */
+
+__attribute__((target("sse2")))
+static void expand_sse2(char *out, uint64_t bits, int count, char fill, char blank)
+{
+   __m128i select = _mm_set_epi8(-128, 64, 32, 16, 8, 4, 2, 1, -128, 64, 32, 16, 8, 4, 2, 1);
+   __m128i fills = _mm_set1_epi8(fill);
+   __m128i blanks = _mm_set1_epi8(blank);
+   __m128i lanes;
+   __m128i set;
+
+   char tail[16];
+
+   while(count > 0)
+   {
+      lanes = _mm_cvtsi32_si128((int)(bits & 0xFFFF));
+      lanes = _mm_unpacklo_epi8(lanes, lanes);
+      lanes = _mm_unpacklo_epi16(lanes, lanes);
+      lanes = _mm_unpacklo_epi32(lanes, lanes);
+      set = _mm_cmpeq_epi8(_mm_and_si128(lanes, select), select);
+      lanes = _mm_or_si128(_mm_and_si128(set, fills), _mm_andnot_si128(set, blanks));
+      if(count < 16)
+      {
+         _mm_storeu_si128((__m128i *)tail, lanes);
+         memcpy(out, tail, count);
+         break;
+      }
+      _mm_storeu_si128((__m128i *)out, lanes);
+      out += 16;
+      bits >>= 16;
+      count -= 16;
+   }
+}
+
+
+/************************
+  expand_avx2 subroutine
+ ************************/
+/** Expands bits into characters 32 at a time, using AVX2.
+  * @param out       Where to write the characters
+  * @param bits      Bits to expand, lowest (leftmost) first
+  * @param count     Number of bits to expand
+  * @param fill      Character written for a set bit
+  * @param blank     Character written for a clear bit
+  */
+
+__attribute__((target("avx2")))
+static void expand_avx2(char *out, uint64_t bits, int count, char fill, char blank)
+{
+   __m256i spread = _mm256_set_epi8(3, 3, 3, 3, 3, 3, 3, 3, 2, 2, 2, 2, 2, 2, 2, 2,
+                                    1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0);
+   __m256i select = _mm256_set1_epi64x((long long)0x8040201008040201ULL);
+   __m256i fills = _mm256_set1_epi8(fill);
+   __m256i blanks = _mm256_set1_epi8(blank);
+   __m256i lanes;
+   __m256i set;
+
+   char tail[32];
+
+   while(count > 0)
+   {
+      lanes = _mm256_shuffle_epi8(_mm256_set1_epi32((int)(bits & 0xFFFFFFFF)), spread);
+      set = _mm256_cmpeq_epi8(_mm256_and_si256(lanes, select), select);
+      lanes = _mm256_blendv_epi8(blanks, fills, set);
+      if(count < 32)
+      {
+         _mm256_storeu_si256((__m256i *)tail, lanes);
+         memcpy(out, tail, count);
+         break;
+      }
+      _mm256_storeu_si256((__m256i *)out, lanes);
+      out += 32;
+      bits >>= 32;
+      count -= 32;
+   }
+}
+
+#endif /* ifdef HAVE_CPU_DISPATCH */
+
+
+/***********************************
+  banner_choose_expander subroutine
+ ***********************************/
+/** Picks the fastest kernel that works on this processor.
+  * @return Kernel to expand bits with.
+  */
+
+expand_func_t banner_choose_expander(void)
+{
+#ifdef HAVE_CPU_DISPATCH
+   __builtin_cpu_init();
+   if(__builtin_cpu_supports("avx2"))
+   {
+      return(expand_avx2);
+   }
+   if(__builtin_cpu_supports("sse2"))
+   {
+      return(expand_sse2);
+   }
+#endif
+
+   return(expand_plain);
+}
@@ -0,0 +1,85 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *
+ *              C E D A R
+ *          S O L U T I O N S       "Software done right."
+ *           S O F T W A R E
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *
+ * Copyright (c) 2000-2004,2007,2013,2014,2020,2024 Kenneth J. Pronovici.
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License,
+ * Version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Copies of the GNU General Public License are available from
+ * the Free Software Foundation website, http://www.gnu.org/.
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *
+ * Author   : Kenneth J. Pronovici <pronovic@ieee.org>
+ * Language : ANSI C
+ * Project  : banner
+ * Purpose  : Kernels that expand glyph bitmaps into characters.
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/********************
+  File documentation
+ ********************/
+
+/** @file
+  * @author Kenneth J. Pronovici
+  * @brief  Kernels that expand glyph bitmaps into characters.
+  *
+  * A kernel turns up to 64 bits of a bitmap row into one character per bit.
+  * The lowest bit is the leftmost column.  There is a plain C kernel that
+  * works everywhere, and SSE2 and AVX2 kernels that are used if the build
+  * supports them and the processor it's running on has them.
+  */
+
+#ifndef EXPAND_H
+#define EXPAND_H
+/*{*/
+
+#include <stdint.h>
+
+
+/******************
+  Macro defintions
+ *******************/
+
+/** Number of bits a kernel can expand at once */
+#define EXPAND_BITS  (64)
+
+
+/******************
+  Type definitions
+ ******************/
+
+/** Expands bits into characters.
+  * @param out       Where to write the characters
+  * @param bits      Bits to expand, lowest (leftmost) first
+  * @param count     Number of bits to expand, no more than @c EXPAND_BITS
+  * @param fill      Character written for a set bit
+  * @param blank     Character written for a clear bit
+  */
+typedef void (*expand_func_t)(char *out, uint64_t bits, int count, char fill, char blank);
+
+
+/***********************
+  Function declarations
+ ***********************/
+
+/** Picks the fastest kernel that works on this processor.
+  * @return Kernel to expand bits with.
+  */
+extern expand_func_t banner_choose_expander(void);
+
+/*}*/
+#endif /* ifndef EXPAND_H */
@@ -0,0 +1,233 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *
+ *              C E D A R
+ *          S O L U T I O N S       "Software done right."
+ *           S O F T W A R E
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *
+ * Copyright (c) 2000-2004,2007,2013,2014,2020,2024 Kenneth J. Pronovici.
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License,
+ * Version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Copies of the GNU General Public License are available from
+ * the Free Software Foundation website, http://www.gnu.org/.
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *
+ * Author   : Kenneth J. Pronovici <pronovic@ieee.org>
+ * Language : ANSI C
+ * Project  : banner
+ * Purpose  : Private definition of fonts, shared within the library.
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/********************
+  File documentation
+ ********************/
+
+/** @file
+  * @author Kenneth J. Pronovici
+  * @brief  Private definition of fonts, shared within the library.
+  *
+  * Nothing in here is installed; callers outside the library only ever see
+  * a @c banner_font_t through a pointer.  The font compiler uses it too,
+  * since a compiled font file is just a font's glyph table and bitmap (or
+  * atlas) written out as they are in memory:
+  *
+    @verbatim
+
+      header     font_header_t, at the start of the file
+      glyphs     pages*GLYPH_PAGE_SIZE entries of glyph_t, a page at a time
+      directory  GLYPH_PAGES entries of uint16_t, the page for each code >> 8
+      bitmap     height rows of words 64-bit words, if the font has a bitmap
+      atlas      height rows of stride characters, if the font has an atlas
+
+    @endverbatim
+  *
+  * Characters are Unicode code points, and the glyph table is split into
+  * pages of @c GLYPH_PAGE_SIZE characters.  The directory gives the page of
+  * the table that each block of characters is in.  Blocks that the font
+  * doesn't draw anything from all share one empty page, so a font only
+  * pays for the blocks it uses.  Page 0 always holds the first block (ASCII
+  * and Latin-1) and page 1 is always the empty page, so ASCII characters can
+  * be looked up directly, and characters past the directory can be sent to
+  * the empty page.
+  *
+  * Everything is in the byte order of the machine the font was compiled on,
+  * and each part starts on a multiple of @c FONT_ALIGN bytes, so the file can
+  * be mapped into memory and used without converting anything.
+  */
+
+#ifndef FONT_H
+#define FONT_H
+/*{*/
+
+#include <stdint.h>
+
+#include "libbanner.h"
+#include "expand.h"
+
+
+/******************
+  Macro defintions
+ *******************/
+
+/** Number of characters in each page of the glyph table */
+#define GLYPH_PAGE_SIZE    (256)
+
+/** Number of pages the directory can point to, covering the Basic Multilingual Plane */
+#define GLYPH_PAGES        (256)
+
+/** Number of characters the glyph table can hold; later ones are never drawn */
+#define GLYPH_CODES        (GLYPH_PAGES*GLYPH_PAGE_SIZE)
+
+/** Page of the glyph table holding ASCII and Latin-1 */
+#define GLYPH_LATIN1_PAGE  (0)
+
+/** Page of the glyph table shared by every block with nothing in it */
+#define GLYPH_EMPTY_PAGE   (1)
+
+/** Finds the glyph for any character (a code point) in a font.  The code is
+  * used more than once, so it mustn't have side effects. */
+#define FONT_GLYPH(font, code) \
+   (&(font)->glyphs[(code) < GLYPH_CODES \
+                    ? (size_t)(font)->directory[(code)/GLYPH_PAGE_SIZE]*GLYPH_PAGE_SIZE + (code) % GLYPH_PAGE_SIZE \
+                    : (size_t)GLYPH_EMPTY_PAGE*GLYPH_PAGE_SIZE])
+
+/** Magic string at the start of a compiled font file */
+#define FONT_MAGIC         "BANNERF\n"
+
+/** Version of the compiled font file format */
+#define FONT_VERSION       (2)
+
+/** Written as-is into a compiled font file, to check its byte order */
+#define FONT_ORDER         (0x01020304)
+
+/** Alignment of each part of a compiled font file, in bytes */
+#define FONT_ALIGN         (8)
+
+
+/******************
+  Type definitions
+ ******************/
+
+/** Describes how to draw a single input character. */
+typedef struct
+{
+   int32_t width;    /**< Width of each row, in characters */
+   int32_t offset;   /**< Offset of the letter within each atlas or bitmap row */
+   int32_t present;  /**< Boolean true (1) if the character is defined */
+   int32_t code;     /**< Character the letter is defined for in the font */
+} glyph_t;
+
+/** One letter of a font, as it is set up from its source. */
+typedef struct
+{
+   int32_t code;              /**< Character the letter is drawn for */
+   const char *const *rows;   /**< Rows of the letter, all the same width */
+} letter_t;
+
+/** A font that banners are drawn in. */
+struct banner_font
+{
+   int height;       /**< Height of every letter, in rows */
+   int space;        /**< Width (in characters) of space between letters */
+   glyph_t *glyphs;  /**< Glyph table, a page at a time, with ASCII and Latin-1 first */
+   uint16_t *directory;    /**< Page of the glyph table for each block of characters */
+   int pages;        /**< Number of pages in the glyph table */
+   char *atlas;      /**< Glyph atlas, one row after another, or NULL if there's a bitmap */
+   int stride;       /**< Distance between the start of each atlas row */
+   uint64_t *bitmap; /**< Glyph bitmap, one row after another, or NULL if there's an atlas */
+   int words;        /**< Number of words in each bitmap row */
+   char fill;        /**< Character drawn for a set bit in the bitmap */
+   char blank;       /**< Character drawn for a clear bit in the bitmap */
+   expand_func_t expand;   /**< Kernel used to expand the bitmap */
+   void *map;        /**< Mapping of the font file, or NULL if not loaded from a file */
+   size_t mapsize;   /**< Size of the mapping */
+   int scale;        /**< Number of times each row is drawn, one under another */
+   int owned;        /**< Boolean true (1) if the tables are freed along with the font */
+   int advance[GLYPH_PAGE_SIZE];    /**< Width of each Latin-1 character with its spacing, or zero if it isn't drawn */
+};
+
+/** Header at the start of a compiled font file. */
+typedef struct
+{
+   char magic[8];    /**< @c FONT_MAGIC, without its terminating null */
+   uint32_t order;   /**< @c FONT_ORDER, in the byte order of the file */
+   uint32_t version; /**< @c FONT_VERSION */
+   int32_t height;   /**< Height of every letter, in rows */
+   int32_t space;    /**< Width (in characters) of space between letters */
+   int32_t stride;   /**< Total width of all of the letters */
+   int32_t words;    /**< Number of words in each bitmap row */
+   int32_t fill;     /**< Character drawn for a set bit in the bitmap */
+   int32_t blank;    /**< Character drawn for a clear bit in the bitmap */
+   uint32_t pages;   /**< Number of pages in the glyph table */
+   uint32_t glyphs;  /**< Offset of the glyph table */
+   uint32_t directory; /**< Offset of the page directory */
+   uint32_t bitmap;  /**< Offset of the bitmap, or zero if there isn't one */
+   uint32_t atlas;   /**< Offset of the atlas, or zero if there isn't one */
+   uint32_t size;    /**< Size of the whole file, in bytes */
+} font_header_t;
+
+
+/***********************
+  Function declarations
+ ***********************/
+
+/** Sets up a font from the rows of each of its letters.
+  * The font's @c height, @c space and @c blank must already be set.  The
+  * glyph table and directory are allocated, the letters are measured and
+  * packed into a bitmap if possible, and into an atlas if not, and then
+  * characters that aren't defined but convert to ones that are (lower-case
+  * letters and whitespace) are given a copy of those characters' glyphs.
+  * @param font      Font to set up
+  * @param letters   Letters to put in the font, each with a code below @c GLYPH_CODES
+  * @param count     Number of letters
+  * @return Boolean true (1) if the font was set up, boolean false (0) if there wasn't enough memory.
+  */
+extern int banner_pack_font(banner_font_t *font, const letter_t *letters, int count);
+
+/** Fills in a font's @c advance table from its glyph table.
+  * @param font      Font to fill in
+  */
+extern void banner_set_advances(banner_font_t *font);
+
+/** Returns the character a font draws at one place in a glyph.
+  * This is slow next to rendering, so it's only used to set up fonts made
+  * from other fonts.
+  * @param font      Font the glyph is in
+  * @param glyph     Glyph to look in, which must be present
+  * @param row       Row within the glyph, less than the font's @c height
+  * @param column    Column within the glyph, less than its @c width
+  * @return Character drawn there.
+  */
+extern char banner_glyph_pixel(const banner_font_t *font, const glyph_t *glyph, int row, int column);
+
+/** Decodes the UTF-8 character at a position in a string.
+  * Bytes that don't start a valid UTF-8 sequence (including overlong forms
+  * and surrogates) are taken to be Latin-1 characters on their own, so text
+  * in the old 8-bit encoding still comes out as it always did.
+  * @param string    String to decode, which need not be null-terminated
+  * @param length    Length of the string
+  * @param position  Position of the character, updated to the one after it
+  * @return Character, as a code point.
+  */
+extern int32_t banner_decode(const char *string, size_t length, size_t *position);
+
+/** Checks whether a string is all ASCII, and so needs no decoding.
+  * @param string    String to check
+  * @param length    Length of the string
+  * @return Boolean true (1) if every byte is below 0x80, boolean false (0) otherwise.
+  */
+extern int banner_is_ascii(const char *string, size_t length);
+
+/*}*/
+#endif /* ifndef FONT_H */
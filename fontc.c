@@ -0,0 +1,1207 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *
+ *              C E D A R
+ *          S O L U T I O N S       "Software done right."
+ *           S O F T W A R E
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *
+ * Copyright (c) 2000-2004,2007,2013,2014,2020,2024 Kenneth J. Pronovici.
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License,
+ * Version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Copies of the GNU General Public License are available from
+ * the Free Software Foundation website, http://www.gnu.org/.
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *
+ * Author   : Kenneth J. Pronovici <pronovic@ieee.org>
+ * Language : ANSI C
+ * Project  : banner
+ * Purpose  : Font compiler, which turns font sources into compiled fonts.
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/********************
+  File documentation
+ ********************/
+
+/** @file
+  * @author Kenneth J. Pronovici
+  * @brief  Font compiler, which turns font sources into compiled fonts.
+  *
+  * The banner-fontc program reads a font source and writes a compiled font
+  * file (described in font.h) that banner_font_open() can map and use as-is.
+  * All of the work of measuring and packing the letters is done here, once,
+  * rather than every time the font is used.  There are three kinds of source:
+  *
+  * A C header in the same style as letters.h, with @c LETTER_HEIGHT and
+  * @c SPACE_WIDTH defined, an array of strings for each letter, and a
+  * @c LETTER_GLYPHS list that says which character each array draws.  Only
+  * those parts of the header are looked at, so the header doesn't need to be
+  * compilable on its own.
+  *
+  * A plain text font, which looks like this:
+  *
+    @verbatim
+
+      # Comments start with a hash.
+      height 3
+      space 1
+      glyph A
+      | # |
+      |###|
+      |# #|
+      glyph 0x20
+      |  |
+      |  |
+      |  |
+
+    @endverbatim
+  *
+  * Each glyph is named by its character (in UTF-8), or by its character
+  * value (a Unicode code point below 0x10000) if it's longer than one
+  * character, and is followed by exactly @c height rows.
+  * Each row is written between bars, so trailing spaces aren't lost.
+  *
+  * A FIGlet font (a @c .flf file).  The required characters (ASCII 32 to 126
+  * and the seven Deutsch characters) and any code-tagged characters from 0 to
+  * 0xFFFF are imported; other code-tagged characters are skipped.  FIGlet's
+  * hardblanks are drawn as spaces, and letters are set next to each other
+  * with no space between them, as FIGlet does at full width.  Smushing and
+  * kerning aren't supported, since letters are never overlapped.
+  *
+  * Either way, the letters are drawn with spaces for blanks, and lower-case
+  * letters and whitespace are drawn with the upper-case letter or space if
+  * the source doesn't define them itself.
+  */
+
+
+/****************
+  Included files
+ ****************/
+
+#include "config.h"
+
+#include <stdio.h>
+
+#ifdef HAVE_STDLIB_H
+   #include <stdlib.h>
+#endif
+
+#ifdef HAVE_STRING_H
+   #include <string.h>
+#endif
+
+#ifdef HAVE_CTYPE_H
+   #include <ctype.h>
+#endif
+
+#include <errno.h>
+
+#include "libbanner.h"
+#include "font.h"
+
+
+/******************
+  Macro defintions
+ *******************/
+
+/** Normal exit status */
+#define NORMAL_EXIT        (0)
+
+/** Error exit status */
+#define ERROR_EXIT         (-1)
+
+/** Token that is a word: an identifier or a number */
+#define TOKEN_WORD         (1)
+
+/** Token that is a string literal */
+#define TOKEN_STRING       (2)
+
+/** Token that is a character literal */
+#define TOKEN_CHAR         (3)
+
+/** Token that is a single punctuation character */
+#define TOKEN_PUNCT        (4)
+
+/** Signature at the start of a FIGlet font, followed by the hardblank */
+#define FIGLET_SIGNATURE   ("flf2a")
+
+/** First of the ASCII characters every FIGlet font defines, in order */
+#define FIGLET_FIRST       (32)
+
+/** Last of the ASCII characters every FIGlet font defines, in order */
+#define FIGLET_LAST        (126)
+
+
+/******************
+  Type definitions
+ ******************/
+
+/** A font source, as read from a file. */
+typedef struct
+{
+   const char *filename;   /**< Name of the file the source was read from */
+   int height;             /**< Height of every letter, or zero if not known yet */
+   int space;              /**< Space between letters, or -1 if not known yet */
+   char ***rows;           /**< Rows of each letter, by character, or NULL if not defined */
+   int *lines;             /**< Line each letter was defined on, by character */
+} source_t;
+
+/** A token in a C header. */
+typedef struct
+{
+   int kind;            /**< Kind of token, one of the TOKEN_* values */
+   const char *start;   /**< Start of the token in the header */
+   size_t length;       /**< Length of the token in the header */
+   char *string;        /**< Contents of a string literal, with escapes replaced */
+   int value;           /**< Value of a character literal or punctuation character */
+   int line;            /**< Line the token is on */
+} token_t;
+
+/** An array of strings in a C header. */
+typedef struct
+{
+   const token_t *name; /**< Name of the array */
+   char **strings;      /**< Strings in the array */
+   int count;           /**< Number of strings in the array */
+} array_t;
+
+
+/******************
+  Global variables
+ ******************/
+
+/** Deutsch characters every FIGlet font defines, in order, after the ASCII ones */
+static const int figlet_deutsch[] = { 196, 214, 220, 228, 246, 252, 223 };
+
+/** Name the program was run as, for error messages */
+static const char *program_name = "banner-fontc";
+
+
+/*****************
+  fail subroutine
+ *****************/
+/** Reports a problem with a font source, and exits.
+  * @param source    Source the problem is in
+  * @param line      Line the problem is on, or zero if it isn't on any one line
+  * @param message   Description of the problem
+  */
+
+static void fail(const source_t *source, int line, const char *message)
+{
+   if(line > 0)
+   {
+      fprintf(stderr, "%s: %s:%d: %s\n", program_name, source->filename, line, message);
+   }
+   else
+   {
+      fprintf(stderr, "%s: %s: %s\n", program_name, source->filename, message);
+   }
+   exit(ERROR_EXIT);
+}
+
+
+/**********************
+  read_file subroutine
+ **********************/
+/** Reads a whole file into memory, as a null-terminated string.
+  * @param filename  Name of the file to read
+  * @return Contents of the file, or NULL with errno set if it couldn't be read.
+  */
+
+static char *read_file(const char *filename)
+{
+   FILE *stream = NULL;
+   char *text = NULL;
+   char *grown = NULL;
+   size_t length = 0;
+   size_t capacity = 0;
+   size_t count = 0;
+   int error = 0;
+
+   stream = fopen(filename, "r");
+   if(stream == NULL)
+   {
+      return(NULL);
+   }
+
+   do
+   {
+      if(capacity - length < BUFSIZ + 1)
+      {
+         capacity = capacity == 0 ? 4*BUFSIZ : 2*capacity;
+         grown = (char *)realloc(text, capacity);
+         if(grown == NULL)
+         {
+            free(text);
+            fclose(stream);
+            errno = ENOMEM;
+            return(NULL);
+         }
+         text = grown;
+      }
+      count = fread(text + length, 1, BUFSIZ, stream);
+      length += count;
+   } while(count > 0);
+
+   error = ferror(stream) ? errno : 0;
+   fclose(stream);
+   if(error != 0)
+   {
+      free(text);
+      errno = error;
+      return(NULL);
+   }
+
+   text[length] = '\0';
+   return(text);
+}
+
+
+/***********************
+  parse_code subroutine
+ ***********************/
+/** Works out which character a glyph in a text font is for.
+  * @param source    Source being parsed
+  * @param line      Line the glyph is defined on
+  * @param name      The character itself, or its character value
+  * @return Character value.
+  */
+
+static int parse_code(const source_t *source, int line, const char *name)
+{
+   long code = 0;
+   size_t length = strlen(name);
+   size_t position = 0;
+   char *end = NULL;
+
+   if(length > 0)
+   {
+      code = banner_decode(name, length, &position);
+      if(position == length && code < GLYPH_CODES)
+      {
+         return((int)code);
+      }
+   }
+
+   code = strtol(name, &end, 0);
+   if(name[0] == '\0' || *end != '\0' || code < 0 || code >= GLYPH_CODES)
+   {
+      fail(source, line, "glyph must be a single character or a character value from 0 to 0xFFFF");
+   }
+
+   return((int)code);
+}
+
+
+/***********************
+  parse_text subroutine
+ ***********************/
+/** Parses a plain text font.
+  * The text is modified in place, and the rows of each letter point into it.
+  * @param source    Source to fill in
+  * @param text      Contents of the font file
+  */
+
+static void parse_text(source_t *source, char *text)
+{
+   int line = 0;
+   int code = -1;
+   int count = 0;
+   char *next = text;
+   char *p = NULL;
+   char *end = NULL;
+   char *keyword = NULL;
+   char *argument = NULL;
+
+   while(next != NULL && *next != '\0')
+   {
+      p = next;
+      line++;
+      next = strchr(p, '\n');
+      if(next != NULL)
+      {
+         *next++ = '\0';
+      }
+      end = p + strlen(p);
+      while(end > p && (end[-1] == '\r' || end[-1] == ' ' || end[-1] == '\t'))
+      {
+         *--end = '\0';
+      }
+      while(*p == ' ' || *p == '\t')
+      {
+         p++;
+      }
+
+      if(*p == '\0' || *p == '#')
+      {
+         continue;   /* blank line or comment */
+      }
+
+      if(*p == '|')
+      {
+         if(code < 0)
+         {
+            fail(source, line, "row is not part of a glyph");
+         }
+         if(count == source->height)
+         {
+            fail(source, line, "glyph has more rows than the font's height");
+         }
+         end = strrchr(p + 1, '|');
+         if(end == NULL)
+         {
+            fail(source, line, "row must end with |");
+         }
+         *end = '\0';
+         source->rows[code][count++] = p + 1;
+         continue;
+      }
+
+      keyword = p;
+      p += strcspn(p, " \t");
+      if(*p != '\0')
+      {
+         *p++ = '\0';
+         p += strspn(p, " \t");
+      }
+      argument = p;
+
+      if(strcmp(keyword, "height") == 0 || strcmp(keyword, "space") == 0)
+      {
+         if(code >= 0)
+         {
+            fail(source, line, "height and space must come before the first glyph");
+         }
+         if(strcmp(keyword, "height") == 0)
+         {
+            source->height = atoi(argument);
+            if(source->height < 1)
+            {
+               fail(source, line, "height must be at least 1");
+            }
+         }
+         else
+         {
+            source->space = atoi(argument);
+            if(source->space < 0 || !isdigit((unsigned char)argument[0]))
+            {
+               fail(source, line, "space must be a number");
+            }
+         }
+      }
+      else if(strcmp(keyword, "glyph") == 0)
+      {
+         if(code >= 0 && count != source->height)
+         {
+            fail(source, source->lines[code], "glyph has fewer rows than the font's height");
+         }
+         if(source->height == 0)
+         {
+            fail(source, line, "height must come before the first glyph");
+         }
+         code = parse_code(source, line, argument);
+         if(source->rows[code] != NULL)
+         {
+            fail(source, line, "glyph is defined more than once");
+         }
+         source->rows[code] = (char **)calloc(source->height, sizeof(char *));
+         if(source->rows[code] == NULL)
+         {
+            fail(source, line, strerror(ENOMEM));
+         }
+         source->lines[code] = line;
+         count = 0;
+      }
+      else
+      {
+         fail(source, line, "expected height, space, glyph or a row");
+      }
+   }
+
+   if(code >= 0 && count != source->height)
+   {
+      fail(source, source->lines[code], "glyph has fewer rows than the font's height");
+   }
+}
+
+
+/**********************
+  next_line subroutine
+ **********************/
+/** Splits the next line off of a font file, in place.
+  * @param next      Start of the next line, updated to the line after it
+  * @param line      Number of the line, updated to count the line
+  * @return The line, without its line ending, or NULL at the end of the file.
+  */
+
+static char *next_line(char **next, int *line)
+{
+   char *start = *next;
+   char *end = NULL;
+
+   if(start == NULL || *start == '\0')
+   {
+      return(NULL);
+   }
+
+   (*line)++;
+   end = strchr(start, '\n');
+   if(end != NULL)
+   {
+      *end = '\0';
+      *next = end + 1;
+   }
+   else
+   {
+      *next = NULL;
+      end = start + strlen(start);
+   }
+
+   if(end > start && end[-1] == '\r')
+   {
+      end[-1] = '\0';
+   }
+
+   return(start);
+}
+
+
+/************************
+  read_figlet subroutine
+ ************************/
+/** Reads one FIGlet character and stores it as a glyph.
+  * The last character of each line is its endmark, and every copy of it at
+  * the end of the line is removed.  Hardblanks are replaced with spaces, and
+  * lines that are shorter than the widest are padded with spaces.
+  * @param source    Source being parsed, whose height is known
+  * @param next      Start of the character's first line, updated past its last
+  * @param line      Number of the line before the character, updated
+  * @param code      Character value to store the glyph as, or -1 to skip it
+  * @param hardblank FIGlet hardblank character
+  */
+
+static void read_figlet(source_t *source, char **next, int *line, int code, char hardblank)
+{
+   int i = 0;
+   int first = *line + 1;
+   size_t width = 0;
+   size_t length = 0;
+   char endmark = 0;
+   char *text = NULL;
+   char *p = NULL;
+   char **rows = NULL;
+   char *block = NULL;
+
+   rows = (char **)calloc(source->height, sizeof(char *));
+   if(rows == NULL)
+   {
+      fail(source, first, strerror(ENOMEM));
+   }
+
+   for(i=0; i<source->height; i++)
+   {
+      text = next_line(next, line);
+      if(text == NULL)
+      {
+         fail(source, first, "character has fewer lines than the font's height");
+      }
+
+      length = strlen(text);
+      endmark = length > 0 ? text[length - 1] : 0;
+      while(length > 0 && text[length - 1] == endmark)
+      {
+         length--;
+      }
+      text[length] = '\0';
+
+      for(p=text; *p != '\0'; p++)
+      {
+         *p = *p == hardblank ? ' ' : *p;
+      }
+
+      rows[i] = text;
+      width = length > width ? length : width;
+   }
+
+   if(code < 0)
+   {
+      free(rows);
+      return;
+   }
+
+   block = (char *)malloc(source->height*(width + 1));
+   if(block == NULL)
+   {
+      fail(source, first, strerror(ENOMEM));
+   }
+
+   for(i=0; i<source->height; i++)
+   {
+      length = strlen(rows[i]);
+      memcpy(block, rows[i], length);
+      memset(block + length, ' ', width - length);
+      block[width] = '\0';
+      rows[i] = block;
+      block += width + 1;
+   }
+
+   source->rows[code] = rows;   /* a later definition replaces an earlier one, as in FIGlet */
+   source->lines[code] = first;
+}
+
+
+/*************************
+  parse_figlet subroutine
+ *************************/
+/** Parses a FIGlet font.
+  * The text is modified in place.
+  * @param source    Source to fill in
+  * @param text      Contents of the font file
+  */
+
+static void parse_figlet(source_t *source, char *text)
+{
+   int i = 0;
+   int line = 0;
+   int comments = 0;
+   int baseline = 0;
+   int maxlength = 0;
+   int layout = 0;
+   long code = 0;
+   char hardblank = 0;
+   char *next = text;
+   char *header = NULL;
+   char *tag = NULL;
+   char *end = NULL;
+
+   header = next_line(&next, &line);
+   hardblank = header[strlen(FIGLET_SIGNATURE)];
+   if(hardblank == '\0'
+      || sscanf(header + strlen(FIGLET_SIGNATURE) + 1, "%d %d %d %d %d",
+                &source->height, &baseline, &maxlength, &layout, &comments) != 5
+      || source->height < 1 || comments < 0)
+   {
+      fail(source, line, "FIGlet header isn't valid");
+   }
+   source->space = 0;
+
+   for(i=0; i<comments; i++)
+   {
+      if(next_line(&next, &line) == NULL)
+      {
+         fail(source, line, "FIGlet font ends in its comments");
+      }
+   }
+
+   /* The required characters, which a few fonts stop short of */
+   for(i=FIGLET_FIRST; i<=FIGLET_LAST && next != NULL && *next != '\0'; i++)
+   {
+      read_figlet(source, &next, &line, i, hardblank);
+   }
+   for(i=0; i<(int)(sizeof(figlet_deutsch)/sizeof(figlet_deutsch[0])) && next != NULL && *next != '\0'; i++)
+   {
+      read_figlet(source, &next, &line, figlet_deutsch[i], hardblank);
+   }
+
+   /* Code-tagged characters, each after a line holding its code */
+   while((tag = next_line(&next, &line)) != NULL)
+   {
+      if(tag[strspn(tag, " \t")] == '\0')
+      {
+         continue;   /* stray blank line */
+      }
+      code = strtol(tag, &end, 0);
+      if(end == tag)
+      {
+         fail(source, line, "expected the code of a code-tagged character");
+      }
+      read_figlet(source, &next, &line, code >= 0 && code < GLYPH_CODES ? (int)code : -1, hardblank);
+   }
+}
+
+
+/*********************
+  unescape subroutine
+ *********************/
+/** Works out the character that an escape sequence in a C literal stands for.
+  * Only the escapes that make sense in a font are understood; any other
+  * character after a backslash stands for itself.
+  * @param c         Character after the backslash
+  * @return Character the escape stands for.
+  */
+
+static int unescape(int c)
+{
+   switch(c)
+   {
+      case 'n':
+         return('\n');
+      case 't':
+         return('\t');
+      default:
+         return(c);
+   }
+}
+
+
+/*************************
+  read_literal subroutine
+ *************************/
+/** Reads a string or character literal out of a C header.
+  * @param source    Source being parsed
+  * @param token     Token to fill in, whose @c start and @c line are already set
+  * @param quote     Quote character the literal starts and ends with
+  * @return Pointer just past the literal.
+  */
+
+static const char *read_literal(const source_t *source, token_t *token, char quote)
+{
+   const char *p = token->start + 1;
+   size_t length = 0;
+
+   token->string = (char *)malloc(strlen(p) + 1);
+   if(token->string == NULL)
+   {
+      fail(source, token->line, strerror(ENOMEM));
+   }
+
+   while(*p != quote)
+   {
+      if(*p == '\0' || *p == '\n')
+      {
+         fail(source, token->line, "literal isn't closed");
+      }
+      if(*p == '\\' && p[1] != '\0')
+      {
+         token->string[length++] = unescape(p[1]);
+         p += 2;
+      }
+      else
+      {
+         token->string[length++] = *p++;
+      }
+   }
+   token->string[length] = '\0';
+
+   token->kind = quote == '"' ? TOKEN_STRING : TOKEN_CHAR;
+   token->value = (unsigned char)token->string[0];
+   if(token->kind == TOKEN_CHAR && length != 1)
+   {
+      fail(source, token->line, "character literal must hold one character");
+   }
+
+   return(p + 1);
+}
+
+
+/*********************
+  tokenize subroutine
+ *********************/
+/** Splits a C header into tokens, skipping whitespace and comments.
+  * @param source    Source being parsed
+  * @param text      Contents of the header
+  * @param count     Returns the number of tokens
+  * @return Tokens, which point into the text.
+  */
+
+static token_t *tokenize(const source_t *source, const char *text, int *count)
+{
+   int line = 1;
+   int capacity = 0;
+   const char *p = text;
+   token_t *tokens = NULL;
+   token_t *grown = NULL;
+   token_t *token = NULL;
+
+   *count = 0;
+   while(*p != '\0')
+   {
+      if(*p == '\n')
+      {
+         line++;
+         p++;
+         continue;
+      }
+      if(isspace((unsigned char)*p))
+      {
+         p++;
+         continue;
+      }
+      if(p[0] == '/' && p[1] == '*')
+      {
+         for(p+=2; *p != '\0' && !(p[0] == '*' && p[1] == '/'); p++)
+         {
+            line += *p == '\n';
+         }
+         p += *p != '\0' ? 2 : 0;
+         continue;
+      }
+      if(p[0] == '/' && p[1] == '/')
+      {
+         p += strcspn(p, "\n");
+         continue;
+      }
+
+      if(*count == capacity)
+      {
+         capacity = capacity == 0 ? 1024 : 2*capacity;
+         grown = (token_t *)realloc(tokens, capacity*sizeof(token_t));
+         if(grown == NULL)
+         {
+            fail(source, line, strerror(ENOMEM));
+         }
+         tokens = grown;
+      }
+
+      token = &tokens[(*count)++];
+      token->start = p;
+      token->string = NULL;
+      token->line = line;
+      if(*p == '"' || *p == '\'')
+      {
+         p = read_literal(source, token, *p);
+      }
+      else if(isalnum((unsigned char)*p) || *p == '_')
+      {
+         while(isalnum((unsigned char)*p) || *p == '_')
+         {
+            p++;
+         }
+         token->kind = TOKEN_WORD;
+         token->value = 0;
+      }
+      else
+      {
+         token->kind = TOKEN_PUNCT;
+         token->value = (unsigned char)*p++;
+      }
+      token->length = p - token->start;
+   }
+
+   return(tokens);
+}
+
+
+/********************
+  is_word subroutine
+ ********************/
+/** Checks whether a token is a particular word.
+  * @param token     Token to check
+  * @param word      Word to check for, or NULL for any word
+  * @return Boolean true (1) if the token is the word, boolean false (0) otherwise.
+  */
+
+static int is_word(const token_t *token, const char *word)
+{
+   if(token->kind != TOKEN_WORD)
+   {
+      return(0);
+   }
+
+   return(word == NULL || (strlen(word) == token->length && strncmp(token->start, word, token->length) == 0));
+}
+
+
+/*********************
+  is_punct subroutine
+ *********************/
+/** Checks whether a token is a particular punctuation character.
+  * @param token     Token to check
+  * @param c         Punctuation character to check for
+  * @return Boolean true (1) if the token is the character, boolean false (0) otherwise.
+  */
+
+static int is_punct(const token_t *token, int c)
+{
+   return(token->kind == TOKEN_PUNCT && token->value == c);
+}
+
+
+/*************************
+  parse_header subroutine
+ *************************/
+/** Parses a C header in the same style as letters.h.
+  * @param source    Source to fill in
+  * @param text      Contents of the header
+  */
+
+static void parse_header(source_t *source, const char *text)
+{
+   int i = 0;
+   int j = 0;
+   int count = 0;
+   int arraycount = 0;
+   int code = 0;
+   token_t *tokens = NULL;
+   const token_t *t = NULL;
+   array_t *arrays = NULL;
+   array_t *array = NULL;
+
+   tokens = tokenize(source, text, &count);
+   arrays = (array_t *)calloc(count/5 + 1, sizeof(array_t));   /* each array takes at least 5 tokens */
+   if(arrays == NULL)
+   {
+      fail(source, 0, strerror(ENOMEM));
+   }
+
+   /* First pass: the dimensions, and every array of strings */
+   for(i=0; i<count; i++)
+   {
+      t = &tokens[i];
+      if(i+4 < count && is_punct(&t[0], '#') && is_word(&t[1], "define") && is_word(&t[2], NULL))
+      {
+         j = is_punct(&t[3], '(') ? 4 : 3;
+         if(is_word(&t[2], "LETTER_HEIGHT") || is_word(&t[2], "SPACE_WIDTH"))
+         {
+            if(!is_word(&t[j], NULL) || !isdigit((unsigned char)t[j].start[0]))
+            {
+               fail(source, t->line, "expected a number");
+            }
+            if(is_word(&t[2], "LETTER_HEIGHT"))
+            {
+               source->height = atoi(t[j].start);
+            }
+            else
+            {
+               source->space = atoi(t[j].start);
+            }
+         }
+      }
+      else if(i+6 < count && is_word(&t[0], "char") && is_punct(&t[1], '*') && is_word(&t[2], NULL)
+              && is_punct(&t[3], '[') && is_punct(&t[4], ']') && is_punct(&t[5], '=') && is_punct(&t[6], '{'))
+      {
+         array = &arrays[arraycount++];
+         array->name = &t[2];
+         for(j=i+7; j<count && !is_punct(&tokens[j], '}'); j++)
+         {
+            array->count += tokens[j].kind == TOKEN_STRING;
+         }
+         array->strings = (char **)calloc(array->count + 1, sizeof(char *));
+         if(array->strings == NULL)
+         {
+            fail(source, t->line, strerror(ENOMEM));
+         }
+         array->count = 0;
+         for(j=i+7; j<count && !is_punct(&tokens[j], '}'); j++)
+         {
+            if(tokens[j].kind == TOKEN_STRING)
+            {
+               array->strings[array->count++] = tokens[j].string;
+            }
+            else if(!is_punct(&tokens[j], ','))
+            {
+               fail(source, tokens[j].line, "expected a string");
+            }
+         }
+         i = j;
+      }
+   }
+
+   if(source->height < 1 || source->space < 0)
+   {
+      fail(source, 0, "LETTER_HEIGHT and SPACE_WIDTH must both be defined");
+   }
+
+   /* Second pass: which character each array draws */
+   for(i=0; i+5<count; i++)
+   {
+      t = &tokens[i];
+      if(is_word(&t[0], "GLYPH") && is_punct(&t[1], '(') && t[2].kind == TOKEN_CHAR
+         && is_punct(&t[3], ',') && is_word(&t[4], NULL) && is_punct(&t[5], ')'))
+      {
+         for(array=NULL, j=0; j<arraycount && array == NULL; j++)
+         {
+            if(arrays[j].name->length == t[4].length && strncmp(arrays[j].name->start, t[4].start, t[4].length) == 0)
+            {
+               array = &arrays[j];
+            }
+         }
+         if(array == NULL)
+         {
+            fail(source, t->line, "glyph uses an array that isn't defined");
+         }
+         if(array->count < source->height)
+         {
+            fail(source, array->name->line, "array has fewer than LETTER_HEIGHT strings");   /* extra ones are ignored */
+         }
+         code = t[2].value;
+         if(source->rows[code] != NULL)
+         {
+            fail(source, t->line, "glyph is defined more than once");
+         }
+         source->rows[code] = array->strings;
+         source->lines[code] = t->line;
+      }
+   }
+
+   free(arrays);   /* the strings themselves now belong to the source */
+   free(tokens);
+}
+
+
+/*************************
+  check_source subroutine
+ *************************/
+/** Checks that a font source describes a usable font.
+  * @param source    Source to check
+  */
+
+static void check_source(const source_t *source)
+{
+   int i = 0;
+   int j = 0;
+   int defined = 0;
+
+   for(i=0; i<GLYPH_CODES; i++)
+   {
+      if(source->rows[i] != NULL)
+      {
+         defined++;
+         for(j=1; j<source->height; j++)
+         {
+            if(strlen(source->rows[i][j]) != strlen(source->rows[i][0]))
+            {
+               fail(source, source->lines[i], "rows of the glyph aren't all the same width");
+            }
+         }
+      }
+   }
+
+   if(defined == 0)
+   {
+      fail(source, 0, "no glyphs are defined");
+   }
+}
+
+
+/**********************
+  write_pad subroutine
+ **********************/
+/** Writes zeros to a stream until it's at a particular offset.
+  * @param stream    Stream to write to
+  * @param at        Offset the stream is at now
+  * @param offset    Offset to pad to
+  * @return Boolean true (1) if the padding was written, boolean false (0) otherwise.
+  */
+
+static int write_pad(FILE *stream, size_t at, size_t offset)
+{
+   static const char zeros[FONT_ALIGN] = { 0 };
+
+   return(offset == at || fwrite(zeros, 1, offset - at, stream) == offset - at);
+}
+
+
+/***********************
+  write_font subroutine
+ ***********************/
+/** Writes a font out as a compiled font file.
+  * @param font      Font to write
+  * @param filename  Name of the file to write
+  * @return Boolean true (1) if the file was written, boolean false (0) with errno set otherwise.
+  */
+
+static int write_font(const banner_font_t *font, const char *filename)
+{
+   FILE *stream = NULL;
+   font_header_t header;
+   size_t count = (size_t)font->pages*GLYPH_PAGE_SIZE;
+   size_t glyphs = 0;
+   size_t directory = 0;
+   size_t data = 0;
+   size_t size = 0;
+   int written = 0;
+   int error = 0;
+
+   glyphs = (sizeof(header) + FONT_ALIGN - 1)/FONT_ALIGN*FONT_ALIGN;
+   directory = (glyphs + count*sizeof(glyph_t) + FONT_ALIGN - 1)/FONT_ALIGN*FONT_ALIGN;
+   data = (directory + GLYPH_PAGES*sizeof(uint16_t) + FONT_ALIGN - 1)/FONT_ALIGN*FONT_ALIGN;
+   if(font->bitmap != NULL)
+   {
+      size = data + (size_t)font->height*font->words*sizeof(uint64_t);
+   }
+   else
+   {
+      size = data + (size_t)font->height*font->stride;
+   }
+   if(size > 0xFFFFFFFFUL)
+   {
+      errno = EFBIG;
+      return(0);
+   }
+
+   memset(&header, 0, sizeof(header));
+   memcpy(header.magic, FONT_MAGIC, sizeof(header.magic));
+   header.order = FONT_ORDER;
+   header.version = FONT_VERSION;
+   header.height = font->height;
+   header.space = font->space;
+   header.stride = font->stride;
+   header.words = font->words;
+   header.fill = (unsigned char)font->fill;
+   header.blank = (unsigned char)font->blank;
+   header.pages = font->pages;
+   header.glyphs = glyphs;
+   header.directory = directory;
+   header.bitmap = font->bitmap != NULL ? data : 0;
+   header.atlas = font->bitmap != NULL ? 0 : data;
+   header.size = size;
+
+   stream = fopen(filename, "wb");
+   if(stream == NULL)
+   {
+      return(0);
+   }
+
+   written = fwrite(&header, sizeof(header), 1, stream) == 1
+             && write_pad(stream, sizeof(header), glyphs)
+             && fwrite(font->glyphs, sizeof(glyph_t), count, stream) == count
+             && write_pad(stream, glyphs + count*sizeof(glyph_t), directory)
+             && fwrite(font->directory, sizeof(uint16_t), GLYPH_PAGES, stream) == GLYPH_PAGES
+             && write_pad(stream, directory + GLYPH_PAGES*sizeof(uint16_t), data)
+             && (font->bitmap != NULL
+                 ? fwrite(font->bitmap, sizeof(uint64_t), (size_t)font->height*font->words, stream) == (size_t)font->height*font->words
+                 : fwrite(font->atlas, 1, (size_t)font->height*font->stride, stream) == (size_t)font->height*font->stride);
+   error = errno;
+
+   if(fclose(stream) != 0 && written)
+   {
+      error = errno;
+      written = 0;
+   }
+
+   if(!written)
+   {
+      remove(filename);
+      errno = error;
+   }
+
+   return(written);
+}
+
+
+/******************
+  usage subroutine
+ ******************/
+/** Prints usage information for the program.
+  * @param program   Name of the program
+  */
+
+static void usage(const char *program)
+{
+   printf("Usage: %s source output\n"
+          "\n"
+          "Compiles a font source into a font file that banner can load with --font.\n"
+          "The source may be a C header in the same style as banner's letters.h, a\n"
+          "FIGlet font (.flf), or a plain text font; see the banner-fontc source for\n"
+          "the text format.\n",
+          program);
+}
+
+
+/**************
+  Main routine
+ **************/
+/** Program main routine.
+  * @param argc      Number of arguments
+  * @param argv      Argument values
+  * @return Integer exit code, @c NORMAL_EXIT or @c ERROR_EXIT.
+  */
+
+int main(int argc, char *argv[])
+{
+   source_t source;
+   char *text = NULL;
+   letter_t *letters = NULL;
+   int count = 0;
+   int i = 0;
+   banner_font_t font;
+
+   program_name = argv[0];
+   if(argc == 2 && (strcmp(argv[1], "-h") == 0 || strcmp(argv[1], "--help") == 0))
+   {
+      usage(argv[0]);
+      exit(NORMAL_EXIT);
+   }
+   if(argc != 3)
+   {
+      usage(argv[0]);
+      exit(ERROR_EXIT);
+   }
+
+   memset(&source, 0, sizeof(source));
+   source.filename = argv[1];
+   source.space = -1;
+   source.rows = (char ***)calloc(GLYPH_CODES, sizeof(char **));
+   source.lines = (int *)calloc(GLYPH_CODES, sizeof(int));
+   if(source.rows == NULL || source.lines == NULL)
+   {
+      fail(&source, 0, strerror(ENOMEM));
+   }
+
+   text = read_file(source.filename);
+   if(text == NULL)
+   {
+      fail(&source, 0, strerror(errno));
+   }
+
+   if(strncmp(text, FIGLET_SIGNATURE, strlen(FIGLET_SIGNATURE)) == 0)
+   {
+      parse_figlet(&source, text);
+   }
+   else if(strstr(text, "LETTER_GLYPHS") != NULL)
+   {
+      parse_header(&source, text);
+   }
+   else
+   {
+      parse_text(&source, text);
+      if(source.height == 0 || source.space < 0)
+      {
+         fail(&source, 0, "height and space must both be given");
+      }
+   }
+   check_source(&source);
+
+   letters = (letter_t *)calloc(GLYPH_CODES, sizeof(letter_t));
+   if(letters == NULL)
+   {
+      fail(&source, 0, strerror(ENOMEM));
+   }
+   for(i=0; i<GLYPH_CODES; i++)
+   {
+      if(source.rows[i] != NULL)
+      {
+         letters[count].code = i;
+         letters[count].rows = (const char *const *)source.rows[i];
+         count++;
+      }
+   }
+
+   memset(&font, 0, sizeof(font));
+   font.height = source.height;
+   font.space = source.space;
+   font.blank = ' ';
+   if(!banner_pack_font(&font, letters, count))
+   {
+      fail(&source, 0, strerror(ENOMEM));
+   }
+
+   if(!write_font(&font, argv[2]))
+   {
+      fprintf(stderr, "%s: %s: %s\n", program_name, argv[2], strerror(errno));
+      exit(ERROR_EXIT);
+   }
+
+   return(NORMAL_EXIT);
+}
@@ -0,0 +1,318 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *
+ *              C E D A R
+ *          S O L U T I O N S       "Software done right."
+ *           S O F T W A R E
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *
+ * Copyright (c) 2000-2004,2007,2013,2014,2020,2024 Kenneth J. Pronovici.
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License,
+ * Version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Copies of the GNU General Public License are available from
+ * the Free Software Foundation website, http://www.gnu.org/.
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *
+ * Author   : Kenneth J. Pronovici <pronovic@ieee.org>
+ * Language : ANSI C
+ * Project  : banner
+ * Purpose  : Fonts loaded from compiled font files.
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/********************
+  File documentation
+ ********************/
+
+/** @file
+  * @author Kenneth J. Pronovici
+  * @brief  Fonts loaded from compiled font files.
+  *
+  * A compiled font file (see font.h) already holds a font's glyph table and
+  * bitmap or atlas exactly as they're laid out in memory.  Opening one is
+  * just a matter of mapping it and pointing a font at the parts of the
+  * mapping.  Nothing is parsed or converted, and the only per-glyph work is
+  * checking that each entry in the (fixed-size) glyph table stays inside the
+  * file, so a damaged font can't make the renderer read past the mapping.
+  */
+
+
+/****************
+  Included files
+ ****************/
+
+#include "config.h"
+
+#ifdef HAVE_STDLIB_H
+   #include <stdlib.h>
+#endif
+
+#ifdef HAVE_STRING_H
+   #include <string.h>
+#endif
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "libbanner.h"
+#include "font.h"
+#include "expand.h"
+
+
+/******************
+  Macro defintions
+ *******************/
+
+/** Tallest font that can be loaded, in rows */
+#define FONT_MAX_HEIGHT    (4096)
+
+/** Widest atlas (or bitmap row) that can be loaded, in characters */
+#define FONT_MAX_STRIDE    (16*1024*1024)
+
+/** Most characters in a font's atlas, kept well clear of INT_MAX so widths can't overflow */
+#define FONT_MAX_AREA      (INT_MAX/4)
+
+
+/**************************
+  check_section subroutine
+ **************************/
+/** Checks that a part of a font file is aligned and inside the file.
+  * @param header    Header of the font file
+  * @param offset    Offset of the part
+  * @param count     Number of items in the part
+  * @param size      Size of each item
+  * @return Boolean true (1) if the part is good, boolean false (0) otherwise.
+  */
+
+static int check_section(const font_header_t *header, uint32_t offset, uint64_t count, uint64_t size)
+{
+   if(offset < sizeof(font_header_t) || offset % FONT_ALIGN != 0 || offset > header->size)
+   {
+      return(0);
+   }
+
+   return(count*size <= header->size - offset);
+}
+
+
+/*************************
+  check_header subroutine
+ *************************/
+/** Checks that a font file's header describes a font this library can use.
+  * @param header    Header of the font file
+  * @param length    Length of the font file
+  * @return Boolean true (1) if the header is good, boolean false (0) otherwise.
+  */
+
+static int check_header(const font_header_t *header, size_t length)
+{
+   if(memcmp(header->magic, FONT_MAGIC, sizeof(header->magic)) != 0
+      || header->order != FONT_ORDER || header->version != FONT_VERSION
+      || header->size != length)
+   {
+      return(0);
+   }
+
+   if(header->height < 1 || header->height > FONT_MAX_HEIGHT || header->stride < 0
+      || header->stride > FONT_MAX_STRIDE || header->space < 0 || header->space > header->stride
+      || (int64_t)header->height*header->stride > FONT_MAX_AREA
+      || header->fill < 0 || header->fill > 255 || header->blank < 0 || header->blank > 255)
+   {
+      return(0);
+   }
+
+   if(header->pages < 2 || header->pages > GLYPH_PAGES
+      || !check_section(header, header->glyphs, (uint64_t)header->pages*GLYPH_PAGE_SIZE, sizeof(glyph_t))
+      || !check_section(header, header->directory, GLYPH_PAGES, sizeof(uint16_t)))
+   {
+      return(0);
+   }
+
+   if(header->bitmap != 0)
+   {
+      return(header->atlas == 0
+             && header->words == (header->stride + EXPAND_BITS - 1)/EXPAND_BITS
+             && check_section(header, header->bitmap, (uint64_t)header->height*header->words, sizeof(uint64_t)));
+   }
+
+   return(header->atlas != 0
+          && check_section(header, header->atlas, (uint64_t)header->height*header->stride, sizeof(char)));
+}
+
+
+/*************************
+  check_glyphs subroutine
+ *************************/
+/** Checks that every page in a font's directory is in its glyph table, and
+  * that every glyph stays inside its bitmap or atlas.
+  * @param font      Font to check
+  * @return Boolean true (1) if the glyphs are good, boolean false (0) otherwise.
+  */
+
+static int check_glyphs(const banner_font_t *font)
+{
+   int i = 0;
+   const glyph_t *glyph = NULL;
+
+   if(font->directory[0] != GLYPH_LATIN1_PAGE)
+   {
+      return(0);
+   }
+
+   for(i=0; i<GLYPH_PAGES; i++)
+   {
+      if(font->directory[i] >= font->pages)
+      {
+         return(0);
+      }
+   }
+
+   for(i=0; i<font->pages*GLYPH_PAGE_SIZE; i++)
+   {
+      glyph = &font->glyphs[i];
+      if(glyph->present)
+      {
+         if(glyph->width < 0 || glyph->offset < 0 || glyph->width > font->stride - glyph->offset
+            || glyph->code < 0 || glyph->code >= GLYPH_CODES)
+         {
+            return(0);
+         }
+         if(font->bitmap != NULL && glyph->width + font->space > EXPAND_BITS)
+         {
+            return(0);
+         }
+      }
+   }
+
+   return(1);
+}
+
+
+/*****************************
+  banner_font_open subroutine
+ *****************************/
+/** Opens a font compiled by banner-fontc.
+  * @param path      Path of the compiled font file
+  * @return Font, or NULL with errno set if it couldn't be opened.
+  */
+
+const banner_font_t *banner_font_open(const char *path)
+{
+   int fd = -1;
+   int error = 0;
+   struct stat st;
+   char *map = NULL;
+   const font_header_t *header = NULL;
+   banner_font_t *font = NULL;
+
+   fd = open(path, O_RDONLY);
+   if(fd < 0)
+   {
+      return(NULL);
+   }
+
+   if(fstat(fd, &st) != 0)
+   {
+      error = errno;
+      close(fd);
+      errno = error;
+      return(NULL);
+   }
+
+   if((size_t)st.st_size < sizeof(font_header_t))
+   {
+      close(fd);
+      errno = EINVAL;
+      return(NULL);
+   }
+
+   map = (char *)mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+   error = errno;
+   close(fd);
+   if(map == MAP_FAILED)
+   {
+      errno = error;
+      return(NULL);
+   }
+
+   header = (const font_header_t *)map;
+   font = (banner_font_t *)malloc(sizeof(banner_font_t));
+   if(font == NULL || !check_header(header, st.st_size))
+   {
+      error = font == NULL ? ENOMEM : EINVAL;
+      free(font);
+      munmap(map, st.st_size);
+      errno = error;
+      return(NULL);
+   }
+
+   font->height = header->height;
+   font->space = header->space;
+   font->glyphs = (glyph_t *)(map + header->glyphs);
+   font->directory = (uint16_t *)(map + header->directory);
+   font->pages = header->pages;
+   font->atlas = header->atlas != 0 ? map + header->atlas : NULL;
+   font->stride = header->stride;
+   font->bitmap = header->bitmap != 0 ? (uint64_t *)(map + header->bitmap) : NULL;
+   font->words = header->words;
+   font->fill = (char)header->fill;
+   font->blank = (char)header->blank;
+   font->expand = font->bitmap != NULL ? banner_choose_expander() : NULL;
+   font->map = map;
+   font->mapsize = st.st_size;
+   font->scale = 1;
+   font->owned = 0;
+
+   if(!check_glyphs(font))
+   {
+      banner_font_close(font);
+      errno = EINVAL;
+      return(NULL);
+   }
+
+   banner_set_advances(font);
+
+   return(font);
+}
+
+
+/******************************
+  banner_font_close subroutine
+ ******************************/
+/** Closes a font opened by banner_font_open() or made by banner_font_scale().
+  * @param font      Font to close, which may be NULL
+  */
+
+void banner_font_close(const banner_font_t *font)
+{
+   if(font != NULL && font->owned)
+   {
+      free(font->glyphs);
+      free(font->directory);
+      free(font->atlas);
+      free(font->bitmap);
+      free((void *)font);
+      return;
+   }
+
+   if(font == NULL || font->map == NULL)
+   {
+      return;   /* nothing to do for the built-in font */
+   }
+
+   munmap(font->map, font->mapsize);
+   free((void *)font);
+}
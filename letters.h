@@ -94,7 +94,7 @@
 #define SPACE_WIDTH       (2)
 
 /** Character 'A' */
-char *char_a[] =   
+static char *char_a[] =   
 { "   #   ",
   "  # #  ",
   " #   # ",
@@ -104,7 +104,7 @@ char *char_a[] =
   "#     #" };
 
 /** Character 'B' */
-char *char_b[] =
+static char *char_b[] =
 { "###### ",
   "#     #",
   "#     #",
@@ -114,7 +114,7 @@ char *char_b[] =
   "###### " };
  
 /** Character 'C' */
-char *char_c[] =
+static char *char_c[] =
 { " ##### ",
   "#     #",
   "#      ",
@@ -124,7 +124,7 @@ char *char_c[] =
   " ##### " };
  
 /** Character 'D' */
-char *char_d[] =
+static char *char_d[] =
 { "###### ",
   "#     #",
   "#     #",
@@ -134,7 +134,7 @@ char *char_d[] =
   "###### " };
  
 /** Character 'E' */
-char *char_e[] =
+static char *char_e[] =
 { "#######",
   "#      ",
   "#      ",
@@ -144,7 +144,7 @@ char *char_e[] =
   "#######" };
  
 /** Character 'F' */
-char *char_f[] =
+static char *char_f[] =
 { "#######",
   "#      ",
   "#      ",
@@ -154,7 +154,7 @@ char *char_f[] =
   "#      " };
 
 /** Character 'G' */
-char *char_g[] =
+static char *char_g[] =
 { " ##### ",
   "#     #",
   "#      ",
@@ -164,7 +164,7 @@ char *char_g[] =
   " ##### " };
  
 /** Character 'H' */
-char *char_h[] =
+static char *char_h[] =
 { "#     #",
   "#     #",
   "#     #",
@@ -174,7 +174,7 @@ char *char_h[] =
   "#     #" };
  
 /** Character 'I' */
-char *char_i[] =
+static char *char_i[] =
 { "###",
   " # ",
   " # ",
@@ -184,7 +184,7 @@ char *char_i[] =
   "###" };
  
 /** Character 'J' */
-char *char_j[] =
+static char *char_j[] =
 { "      #",
   "      #",
   "      #",
@@ -194,7 +194,7 @@ char *char_j[] =
   " ##### " };
  
 /** Character 'K' */
-char *char_k[] =
+static char *char_k[] =
 { "#    #",
   "#   # ",
   "#  #  ",
@@ -204,7 +204,7 @@ char *char_k[] =
   "#    #" };
  
 /** Character 'L' */
-char *char_l[] =
+static char *char_l[] =
 { "#      ",
   "#      ",
   "#      ",
@@ -214,7 +214,7 @@ char *char_l[] =
   "#######" };
 
 /** Character 'M' */
-char *char_m[] =
+static char *char_m[] =
 { "#     #",
   "##   ##",
   "# # # #",
@@ -224,7 +224,7 @@ char *char_m[] =
   "#     #" };
  
 /** Character 'N' */
-char *char_n[] =
+static char *char_n[] =
 { "#     #",
   "##    #",
   "# #   #",
@@ -234,7 +234,7 @@ char *char_n[] =
   "#     #" };
  
 /** Character 'O' */
-char *char_o[] =
+static char *char_o[] =
 { "#######",
   "#     #",
   "#     #",
@@ -244,7 +244,7 @@ char *char_o[] =
   "#######" };
  
 /** Character 'P' */
-char *char_p[] =
+static char *char_p[] =
 { "###### ",
   "#     #",
   "#     #",
@@ -254,7 +254,7 @@ char *char_p[] =
   "#      " };
  
 /** Character 'Q' */
-char *char_q[] =
+static char *char_q[] =
 { " ##### ",
   "#     #",
   "#     #",
@@ -264,7 +264,7 @@ char *char_q[] =
   " #### #" };
  
 /** Character 'R' */
-char *char_r[] =
+static char *char_r[] =
 { "###### ",
   "#     #",
   "#     #",
@@ -274,7 +274,7 @@ char *char_r[] =
   "#     #" };
 
 /** Character 'S' */
-char *char_s[] =
+static char *char_s[] =
 { " ##### ",
   "#     #",
   "#      ",
@@ -284,7 +284,7 @@ char *char_s[] =
   " ##### " };
  
 /** Character 'T' */
-char *char_t[] =
+static char *char_t[] =
 { "#######",
   "   #   ",
   "   #   ",
@@ -294,7 +294,7 @@ char *char_t[] =
   "   #   " };
  
 /** Character 'U' */
-char *char_u[] =
+static char *char_u[] =
 { "#     #",
   "#     #",
   "#     #",
@@ -304,7 +304,7 @@ char *char_u[] =
   " ##### " };
  
 /** Character 'V' */
-char *char_v[] =
+static char *char_v[] =
 { "#     #",
   "#     #",
   "#     #",
@@ -314,7 +314,7 @@ char *char_v[] =
   "   #   " };
  
 /** Character 'W' */
-char *char_w[] =
+static char *char_w[] =
 { "#     #",
   "#  #  #",
   "#  #  #",
@@ -324,7 +324,7 @@ char *char_w[] =
   " ## ## " };
  
 /** Character 'X' */
-char *char_x[] =
+static char *char_x[] =
 { "#     #",
   " #   # ",
   "  # #  ",
@@ -334,7 +334,7 @@ char *char_x[] =
   "#     #" };
 
 /** Character 'Y' */
-char *char_y[] =
+static char *char_y[] =
 { "#     #",
   " #   # ",
   "  # #  ",
@@ -344,7 +344,7 @@ char *char_y[] =
   "   #   " };
  
 /** Character 'Z' */
-char *char_z[] =
+static char *char_z[] =
 { "#######",
   "     # ",
   "    #  ",
@@ -354,7 +354,7 @@ char *char_z[] =
   "#######" };
 
 /** Character '0' (zero) */
-char *char_0[] =
+static char *char_0[] =
 { " #### ",
   "#   ##",
   "#  # #",
@@ -364,7 +364,7 @@ char *char_0[] =
   " #### " };
 
 /** Character '1' */
-char *char_1[] =
+static char *char_1[] =
 { "  #  ",
   " ##  ",
   "# #  ",
@@ -374,7 +374,7 @@ char *char_1[] =
   "#####" };
 
 /** Character '2' */
-char *char_2[] =
+static char *char_2[] =
 { " ### ",
   "#   #",
   "#   #",
@@ -384,7 +384,7 @@ char *char_2[] =
   "#####",};
 
 /** Character '3' */
-char *char_3[] =
+static char *char_3[] =
 { " ### ",
   "#   #",
   "    #",
@@ -394,7 +394,7 @@ char *char_3[] =
   " ### " };
 
 /** Character '4' */
-char *char_4[] =
+static char *char_4[] =
 { "#   #",
   "#   #",
   "#   #",
@@ -404,7 +404,7 @@ char *char_4[] =
   "    #" };
 
 /** Character '5' */
-char *char_5[] =
+static char *char_5[] =
 { "#####",
   "#    ",
   "#    ",
@@ -414,7 +414,7 @@ char *char_5[] =
   "#####" };
 
 /** Character '6' */
-char *char_6[] =
+static char *char_6[] =
 { " ### ",
   "#   #",
   "#    ",
@@ -424,7 +424,7 @@ char *char_6[] =
   " ### " };
 
 /** Character '7' */
-char *char_7[] =
+static char *char_7[] =
 { "#####",
   "    #",
   "   # ",
@@ -434,7 +434,7 @@ char *char_7[] =
   " #   " };
 
 /** Character '8' */
-char *char_8[] =
+static char *char_8[] =
 { " ### ",
   "#   #",
   "#   #",
@@ -444,7 +444,7 @@ char *char_8[] =
   " ### " };
 
 /** Character '9' */
-char *char_9[] =
+static char *char_9[] =
 { " ### ",
   "#   #",
   "#   #",
@@ -454,7 +454,7 @@ char *char_9[] =
   "#    " };
 
 /** Character '-' (dash) */
-char *char_hash[] =
+static char *char_hash[] =
 { "  # #  ",
   "  # #  ",
   "#######",
@@ -464,7 +464,7 @@ char *char_hash[] =
   "  # #  " };
 
 /** Character '~' (tilde) */
-char *char_tild[] =
+static char *char_tild[] =
 { " ##    ",
   "#  #  #",
   "    ## ",
@@ -474,7 +474,7 @@ char *char_tild[] =
   "       " };
 
 /** Character '!' (exclamation point) */
-char *char_excl[] =
+static char *char_excl[] =
 { " ### ",
   " ### ",
   " ### ",
@@ -484,7 +484,7 @@ char *char_excl[] =
   " ### " };
 
 /** Character '\@' (at sign) */
-char *char_atsg[] =
+static char *char_atsg[] =
 { " ##### ",
   "#     #",
   "# ### #",
@@ -494,7 +494,7 @@ char *char_atsg[] =
   " ##### " };
 
 /** Character '$' (dollar sign) */
-char *char_dolr[] =
+static char *char_dolr[] =
 { " ##### ",
   "#  #  #",
   "#  #   ",
@@ -504,7 +504,7 @@ char *char_dolr[] =
   " ##### " };
 
 /** Character '%' (dollar sign) */
-char *char_prct[] =
+static char *char_prct[] =
 { "###   #",
   "# #  # ",
   "### #  ",
@@ -514,7 +514,7 @@ char *char_prct[] =
   "#   ###" };
 
 /** Character '^' (caret) */
-char *char_crrt[] =
+static char *char_crrt[] =
 { "  #  ",
   " # # ",
   "#   #",
@@ -524,7 +524,7 @@ char *char_crrt[] =
   "     " };
 
 /** Character '&' (ampersand) */
-char *char_ampr[] =
+static char *char_ampr[] =
 { "  ##   ",
   " #  #  ",
   "  ##   ",
@@ -534,7 +534,7 @@ char *char_ampr[] =
   " ###  #" };
 
 /** Character '*' (star) */
-char *char_star[] =
+static char *char_star[] =
 { "       ",
   " #   # ",
   "  # #  ",
@@ -544,7 +544,7 @@ char *char_star[] =
   "       " };
 
 /** Character ')' (right parenthesis) */
-char *char_rpar[] =
+static char *char_rpar[] =
 { "##  ",
   "  # ",
   "   #",
@@ -554,7 +554,7 @@ char *char_rpar[] =
   "##  " };
 
 /** Character '(' (left parenthesis) */
-char *char_lpar[] =
+static char *char_lpar[] =
 { "  ##",
   " #  ",
   "#   ",
@@ -564,7 +564,7 @@ char *char_lpar[] =
   "  ##" };
 
 /** Character '_' (underscore) */
-char *char_undr[] =
+static char *char_undr[] =
 { "     ",
   "     ",
   "     ",
@@ -574,7 +574,7 @@ char *char_undr[] =
   "#####" };
  
 /** Character '+' (plus sign) */
-char *char_plus[] =
+static char *char_plus[] =
 { "       ",
   "   #   ",
   "   #   ",
@@ -585,7 +585,7 @@ char *char_plus[] =
   "       " };
  
 /** Character '+' (equals sign) */
-char *char_equl[] =
+static char *char_equl[] =
 { "       ",
   "       ",
   " ##### ",
@@ -596,7 +596,7 @@ char *char_equl[] =
   "       " };
  
 /** Character '}' (right brace) */
-char *char_rbrc[] =
+static char *char_rbrc[] =
 { "###  ",
   "   # ",
   "   # ",
@@ -606,7 +606,7 @@ char *char_rbrc[] =
   "###  " };
 
 /** Character '{' (left brace) */
-char *char_lbrc[] =
+static char *char_lbrc[] =
 { "  ###",
   " #   ",
   " #   ",
@@ -616,7 +616,7 @@ char *char_lbrc[] =
   "  ###" };
 
 /** Character ']' (right bracket) */
-char *char_rbrk[] =
+static char *char_rbrk[] =
 { "#####",
   "    #",
   "    #",
@@ -626,7 +626,7 @@ char *char_rbrk[] =
   "#####" };
 
 /** Character '[' (left bracket) */
-char *char_lbrk[] =
+static char *char_lbrk[] =
 { "#####",
   "#    ",
   "#    ",
@@ -636,7 +636,7 @@ char *char_lbrk[] =
   "#####" };
 
 /** Character '|' (pipe) */
-char *char_pipe[] =
+static char *char_pipe[] =
 { " # ",
   " # ",
   " # ",
@@ -646,7 +646,7 @@ char *char_pipe[] =
   " # " };
 
 /** Character '\' (left slash) */
-char *char_lsls[] =
+static char *char_lsls[] =
 { "#      ",
   " #     ",
   "  #    ",
@@ -656,7 +656,7 @@ char *char_lsls[] =
   "      #" };
 
 /** Character ':' (colon) */
-char *char_coln[] =
+static char *char_coln[] =
 { " ### ",
   " ### ",
   " ### ",
@@ -666,7 +666,7 @@ char *char_coln[] =
   " ### " };
 
 /** Character ';' (semicolon) */
-char *char_scln[] =
+static char *char_scln[] =
 { " ### ",
   " ### ",
   "     ",
@@ -676,7 +676,7 @@ char *char_scln[] =
   " #   " };
 
 /** Character '"' (double quote) */
-char *char_quot[] =
+static char *char_quot[] =
 { " ### ### ",
   " ### ### ",
   "  #   #  ",
@@ -686,7 +686,7 @@ char *char_quot[] =
   "         " };
 
 /** Character ''' (single quote) */
-char *char_squt[] =
+static char *char_squt[] =
 { " ### ",
   " ### ",
   "  #  ",
@@ -696,7 +696,7 @@ char *char_squt[] =
   "     " };
 
 /** Character '`' (backtick) */
-char *char_btck[] =
+static char *char_btck[] =
 { " ### ",
   " ### ",
   "  #  ",
@@ -706,7 +706,7 @@ char *char_btck[] =
   "     " };
 
 /** Character '>' (right arrow) */
-char *char_rarw[] =
+static char *char_rarw[] =
 { " #    ",
   "  #   ",
   "   #  ",
@@ -716,7 +716,7 @@ char *char_rarw[] =
   " #    " };
 
 /** Character '<' (left arrow) */
-char *char_larw[] =
+static char *char_larw[] =
 { "    # ",
   "   #  ",
   "  #   ",
@@ -726,7 +726,7 @@ char *char_larw[] =
   "    # " };
  
 /** Character '.' (period) */
-char *char_perd[] =
+static char *char_perd[] =
 { "     ",
   "     ",
   "     ",
@@ -736,7 +736,7 @@ char *char_perd[] =
   " ### " };
 
 /** Character ',' (comma) */
-char *char_coma[] =
+static char *char_coma[] =
 { "     ",
   "     ",
   "     ",
@@ -746,7 +746,7 @@ char *char_coma[] =
   " #   " };
  
 /** Character '?' (question mark) */
-char *char_ques[] =
+static char *char_ques[] =
 { " ##### ",
   "#     #",
   "      #",
@@ -756,7 +756,7 @@ char *char_ques[] =
   "   #   " };
 
 /** Character '/' (right slash) */
-char *char_rsls[] =
+static char *char_rsls[] =
 { "      #",
   "     # ",
   "    #  ",
@@ -766,7 +766,7 @@ char *char_rsls[] =
   "#      " };
  
 /** Character '-' (dash) */
-char *char_dash[] =
+static char *char_dash[] =
 { "       ",
   "       ",
   "       ",
@@ -776,7 +776,7 @@ char *char_dash[] =
   "       " };
 
 /** Character ' ' (space) */
-char *char_spac[] =
+static char *char_spac[] =
 { "    ",
   "    ",
   "    ",
@@ -785,6 +785,83 @@ char *char_spac[] =
   "    ",
   "    " };
 
+/**
+  * List of every defined character along with the array that draws it.  The
+  * list is expanded with a caller-supplied @c GLYPH(letter, rows) macro, which
+  * is how banner.c builds its glyph lookup table at compile time.  If you add
+  * a character above, add it here too.
+  */
+#define LETTER_GLYPHS(GLYPH) \
+   GLYPH('A', char_a) \
+   GLYPH('B', char_b) \
+   GLYPH('C', char_c) \
+   GLYPH('D', char_d) \
+   GLYPH('E', char_e) \
+   GLYPH('F', char_f) \
+   GLYPH('G', char_g) \
+   GLYPH('H', char_h) \
+   GLYPH('I', char_i) \
+   GLYPH('J', char_j) \
+   GLYPH('K', char_k) \
+   GLYPH('L', char_l) \
+   GLYPH('M', char_m) \
+   GLYPH('N', char_n) \
+   GLYPH('O', char_o) \
+   GLYPH('P', char_p) \
+   GLYPH('Q', char_q) \
+   GLYPH('R', char_r) \
+   GLYPH('S', char_s) \
+   GLYPH('T', char_t) \
+   GLYPH('U', char_u) \
+   GLYPH('V', char_v) \
+   GLYPH('W', char_w) \
+   GLYPH('X', char_x) \
+   GLYPH('Y', char_y) \
+   GLYPH('Z', char_z) \
+   GLYPH('0', char_0) \
+   GLYPH('1', char_1) \
+   GLYPH('2', char_2) \
+   GLYPH('3', char_3) \
+   GLYPH('4', char_4) \
+   GLYPH('5', char_5) \
+   GLYPH('6', char_6) \
+   GLYPH('7', char_7) \
+   GLYPH('8', char_8) \
+   GLYPH('9', char_9) \
+   GLYPH('#', char_hash) \
+   GLYPH('~', char_tild) \
+   GLYPH('!', char_excl) \
+   GLYPH('@', char_atsg) \
+   GLYPH('$', char_dolr) \
+   GLYPH('%', char_prct) \
+   GLYPH('^', char_crrt) \
+   GLYPH('&', char_ampr) \
+   GLYPH('*', char_star) \
+   GLYPH(')', char_rpar) \
+   GLYPH('(', char_lpar) \
+   GLYPH('_', char_undr) \
+   GLYPH('+', char_plus) \
+   GLYPH('=', char_equl) \
+   GLYPH('}', char_rbrc) \
+   GLYPH('{', char_lbrc) \
+   GLYPH(']', char_rbrk) \
+   GLYPH('[', char_lbrk) \
+   GLYPH('|', char_pipe) \
+   GLYPH('\\', char_lsls) \
+   GLYPH(':', char_coln) \
+   GLYPH(';', char_scln) \
+   GLYPH('\"', char_quot) \
+   GLYPH('\'', char_squt) \
+   GLYPH('`', char_btck) \
+   GLYPH('>', char_rarw) \
+   GLYPH('<', char_larw) \
+   GLYPH('.', char_perd) \
+   GLYPH(',', char_coma) \
+   GLYPH('?', char_ques) \
+   GLYPH('/', char_rsls) \
+   GLYPH('-', char_dash) \
+   GLYPH(' ', char_spac)
+
 
 /*}*/
 #endif /* ifndef LETTERS_H */
@@ -0,0 +1,1283 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *
+ *              C E D A R
+ *          S O L U T I O N S       "Software done right."
+ *           S O F T W A R E
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *
+ * Copyright (c) 2000-2004,2007,2013,2014,2020,2024 Kenneth J. Pronovici.
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License,
+ * Version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Copies of the GNU General Public License are available from
+ * the Free Software Foundation website, http://www.gnu.org/.
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *
+ * Author   : Kenneth J. Pronovici <pronovic@ieee.org>
+ * Language : ANSI C
+ * Project  : banner
+ * Purpose  : Banner rendering library.
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/********************
+  File documentation
+ ********************/
+
+/** @file
+  * @author Kenneth J. Pronovici
+  * @brief  Banner rendering library.
+  *
+  * Each letter/character still has a hardcoded name in letters.h, but
+  * add_to_banner() doesn't switch on them.  Instead, the @c LETTER_GLYPHS
+  * list in letters.h is used to build a glyph table that is indexed by
+  * character.  Characters that aren't defined are found in the same table,
+  * with their @c present flag unset.
+  *
+  * Strings are UTF-8.  The table is split into pages (see font.h), so any
+  * character in the Basic Multilingual Plane can be looked up with two
+  * indexes, but ASCII is so common that it's looked up before anything is
+  * decoded: a byte below 0x80 is its own character, and a string that's all
+  * ASCII (which is checked a word at a time) is rendered without decoding at
+  * all.  Bytes that aren't valid UTF-8 are taken as Latin-1.
+  *
+  * The first time the built-in font is asked for, init_glyphs() packs all of
+  * the letters into a bitmap that holds one row of bits after another, with
+  * every letter's bits back to back.  Since the letters are only ever drawn
+  * with one character, a bit per column is all that's needed, and the whole
+  * font is a few hundred bytes.  Each line of the banner is put together as
+  * bits, 64 columns at a time, and then expanded into characters with the
+  * fastest kernel the processor supports (see expand.c).
+  *
+  * Fonts that draw with more than one character (or that have letters too
+  * wide to fit in the kernel's bits) are packed into an "atlas" instead, which
+  * holds the letters' characters rather than their bits.  Adding a letter to
+  * the banner is then just a copy out of the atlas for each row, at the
+  * letter's offset.
+  *
+  * A font scaled with banner_font_scale() is a new font, with each letter
+  * widened once, up front, and packed like any other.  Its rows are only
+  * drawn once each as well: every row after the first in each group of
+  * @c scale is a copy of a finished row, so a big banner costs the same to
+  * render, per byte, as a small one.
+  */
+
+
+/****************
+  Included files
+ ****************/
+
+#include "config.h"
+
+#include <errno.h>
+#include <limits.h>
+
+#ifdef HAVE_STDLIB_H
+   #include <stdlib.h>
+#endif
+
+#ifdef HAVE_STRING_H
+   #include <string.h>
+#endif
+
+#ifdef HAVE_PTHREAD_H
+   #include <pthread.h>
+#endif
+
+#include "letters.h"
+#include "libbanner.h"
+#include "font.h"
+#include "expand.h"
+
+
+/******************
+  Type definitions
+ ******************/
+
+/** A range of lower-case letters, and how far each is from its upper-case letter. */
+typedef struct
+{
+   int32_t first;    /**< First lower-case letter */
+   int32_t last;     /**< Last lower-case letter */
+   int32_t step;     /**< Distance from one lower-case letter to the next */
+   int32_t delta;    /**< Distance from each lower-case letter to its upper-case letter */
+} case_fold_t;
+
+/** A line of a banner being drawn from a bitmap, as bits not yet expanded. */
+typedef struct
+{
+   char *out;        /**< Where the next expanded character goes */
+   uint64_t bits;    /**< Bits not yet expanded, lowest (leftmost) first */
+   int used;         /**< Number of bits not yet expanded, always less than @c EXPAND_BITS */
+} bitline_t;
+
+
+/******************
+  Global variables
+ ******************/
+
+/** Expands one entry of @c LETTER_GLYPHS into a letter list initializer. */
+#define LETTER_ENTRY(letter, rows) { (unsigned char)(letter), (const char *const *)(rows) },
+
+/** Each letter in letters.h, with the character it's drawn for. */
+static const letter_t builtin_letters[] = { LETTER_GLYPHS(LETTER_ENTRY) };
+
+/** Built-in font, set up by init_glyphs(). */
+static banner_font_t builtin_font = { LETTER_HEIGHT, SPACE_WIDTH, NULL, NULL, 0, NULL, 0, NULL, 0, '#', ' ', NULL, NULL, 0, 1, 0, { 0 } };
+
+/**
+  * Lower-case letters that are drawn with their upper-case letter when a font
+  * doesn't define them itself.  This covers the scripts a banner font might
+  * plausibly draw, without depending on the C library's idea of the locale.
+  */
+static const case_fold_t case_folds[] =
+{
+   { 0x0061, 0x007A, 1, -32 },   /* ASCII */
+   { 0x00E0, 0x00F6, 1, -32 },   /* Latin-1, around the division sign */
+   { 0x00F8, 0x00FE, 1, -32 },
+   { 0x00FF, 0x00FF, 1, 121 },
+   { 0x0101, 0x012F, 2, -1 },    /* Latin Extended-A, in pairs */
+   { 0x0131, 0x0131, 1, -232 },  /* dotless i, drawn as I rather than I with a dot */
+   { 0x0133, 0x0137, 2, -1 },
+   { 0x013A, 0x0148, 2, -1 },
+   { 0x014B, 0x0177, 2, -1 },
+   { 0x017A, 0x017E, 2, -1 },
+   { 0x03AC, 0x03AC, 1, -38 },   /* Greek, with tonos */
+   { 0x03AD, 0x03AF, 1, -37 },
+   { 0x03B1, 0x03C1, 1, -32 },   /* Greek */
+   { 0x03C2, 0x03C2, 1, -31 },
+   { 0x03C3, 0x03CB, 1, -32 },
+   { 0x03CC, 0x03CC, 1, -64 },
+   { 0x03CD, 0x03CE, 1, -63 },
+   { 0x0430, 0x044F, 1, -32 },   /* Cyrillic */
+   { 0x0450, 0x045F, 1, -80 },
+};
+
+#ifdef HAVE_PTHREAD_H
+/** Makes sure init_glyphs() is only called once. */
+static pthread_once_t builtin_once = PTHREAD_ONCE_INIT;
+#else
+/** Boolean true (1) once init_glyphs() has been called. */
+static int builtin_once = 0;
+#endif
+
+
+/***********************
+  pack_atlas subroutine
+ ***********************/
+/** Packs all of a font's glyphs into its atlas.
+  * The glyphs must already have been measured, with @c stride set to their
+  * total width.
+  * @param font      Font to pack
+  * @param rows      Rows of each glyph, indexed like the glyph table
+  * @return Boolean true (1) if the atlas was packed, boolean false (0) if there wasn't enough memory.
+  */
+
+static int pack_atlas(banner_font_t *font, const char *const *const *rows)
+{
+   int i = 0;
+   int j = 0;
+   char *atlas = NULL;
+   const glyph_t *glyph = NULL;
+
+   atlas = (char *)malloc(font->height*font->stride*sizeof(char));
+   if(atlas == NULL)
+   {
+      return(0);
+   }
+
+   for(j=0; j<font->height; j++)
+   {
+      for(i=0; i<font->pages*GLYPH_PAGE_SIZE; i++)
+      {
+         glyph = &font->glyphs[i];
+         if(glyph->present)
+         {
+            memcpy(atlas + j*font->stride + glyph->offset, rows[i][j], glyph->width);
+         }
+      }
+   }
+
+   font->atlas = atlas;
+   return(1);
+}
+
+
+/************************
+  pack_bitmap subroutine
+ ************************/
+/** Packs all of a font's glyphs into its bitmap, if they can be.
+  * That only works if every glyph is drawn with the blank character and one
+  * other (fill) character, and no glyph (with its spacing) is wider than a
+  * kernel can expand.
+  * The glyphs must already have been measured, with @c stride set to their
+  * total width.
+  * @param font      Font to pack, whose @c blank must be set
+  * @param rows      Rows of each glyph, indexed like the glyph table
+  * @return Boolean true (1) if the bitmap was packed, boolean false (0) otherwise.
+  */
+
+static int pack_bitmap(banner_font_t *font, const char *const *const *rows)
+{
+   int i = 0;
+   int j = 0;
+   int k = 0;
+   int column = 0;
+   char fill = font->blank;
+   uint64_t *bitmap = NULL;
+   const glyph_t *glyph = NULL;
+
+   for(i=0; i<font->pages*GLYPH_PAGE_SIZE; i++)
+   {
+      glyph = &font->glyphs[i];
+      if(glyph->present)
+      {
+         if(glyph->width + font->space > EXPAND_BITS)
+         {
+            return(0);
+         }
+         for(j=0; j<font->height; j++)
+         {
+            for(k=0; k<glyph->width; k++)
+            {
+               if(rows[i][j][k] != font->blank && rows[i][j][k] != fill)
+               {
+                  if(fill != font->blank)
+                  {
+                     return(0);   /* a third character */
+                  }
+                  fill = rows[i][j][k];
+               }
+            }
+         }
+      }
+   }
+
+   font->words = (font->stride + EXPAND_BITS - 1)/EXPAND_BITS;
+   bitmap = (uint64_t *)calloc(font->height*font->words, sizeof(uint64_t));
+   if(bitmap == NULL)
+   {
+      return(0);
+   }
+
+   for(i=0; i<font->pages*GLYPH_PAGE_SIZE; i++)
+   {
+      glyph = &font->glyphs[i];
+      if(glyph->present)
+      {
+         for(j=0; j<font->height; j++)
+         {
+            for(k=0; k<glyph->width; k++)
+            {
+               if(rows[i][j][k] != font->blank)
+               {
+                  column = glyph->offset + k;
+                  bitmap[j*font->words + column/EXPAND_BITS] |= (uint64_t)1 << (column % EXPAND_BITS);
+               }
+            }
+         }
+      }
+   }
+
+   font->bitmap = bitmap;
+   font->fill = fill;
+   font->expand = banner_choose_expander();
+   return(1);
+}
+
+
+/*********************
+  is_space subroutine
+ *********************/
+/** Checks whether a character is whitespace, which is drawn as a space.
+  * @param code      Character to check
+  * @return Boolean true (1) if the character is whitespace, boolean false (0) otherwise.
+  */
+
+static int is_space(int32_t code)
+{
+   return(code == ' ' || (code >= '\t' && code <= '\r') || code == 0x85 || code == 0xA0
+          || code == 0x1680 || (code >= 0x2000 && code <= 0x200A) || code == 0x2028
+          || code == 0x2029 || code == 0x202F || code == 0x205F || code == 0x3000);
+}
+
+
+/**********************
+  fold_code subroutine
+ **********************/
+/** Works out which character another character is drawn as, if a font
+  * doesn't define it: whitespace is drawn as a space, and lower-case letters
+  * as their upper-case letter.
+  * @param code      Character to fold
+  * @return Character to draw instead, which is @c code itself if there is none.
+  */
+
+static int32_t fold_code(int32_t code)
+{
+   size_t i = 0;
+   const case_fold_t *fold = NULL;
+
+   if(is_space(code))
+   {
+      return(' ');
+   }
+
+   for(i=0; i<sizeof(case_folds)/sizeof(case_folds[0]); i++)
+   {
+      fold = &case_folds[i];
+      if(code >= fold->first && code <= fold->last && (code - fold->first) % fold->step == 0)
+      {
+         return(code + fold->delta);
+      }
+   }
+
+   return(code);
+}
+
+
+/*****************************
+  banner_pack_font subroutine
+ *****************************/
+/** Sets up a font from the rows of each of its letters.
+  * All rows of a letter are the same width, so the first row is measured.
+  *
+  * The glyph table gets the Latin-1 page, the empty page, and a page for
+  * each other block that has a letter in it.  Once the glyphs are packed,
+  * each character that isn't defined but converts to one that is (lower-case
+  * letters and whitespace) is given a copy of that character's entry, as
+  * long as its page is in the table anyway.  That way, strings never have to
+  * be converted before they're looked up, and can be used without modifying
+  * them.
+  * @param font      Font to set up
+  * @param letters   Letters to put in the font
+  * @param count     Number of letters
+  * @return Boolean true (1) if the font was set up, boolean false (0) if there wasn't enough memory.
+  */
+
+int banner_pack_font(banner_font_t *font, const letter_t *letters, int count)
+{
+   int i = 0;
+   int page = 0;
+   int width = 0;
+   int packed = 0;
+   int32_t code = 0;
+   int32_t target = 0;
+   glyph_t *glyph = NULL;
+   const glyph_t *folded = NULL;
+   const char *const **rows = NULL;
+
+   font->atlas = NULL;
+   font->bitmap = NULL;
+   font->map = NULL;
+   font->pages = 2;   /* Latin-1 and the empty page */
+
+   font->directory = (uint16_t *)malloc(GLYPH_PAGES*sizeof(uint16_t));
+   if(font->directory == NULL)
+   {
+      return(0);
+   }
+
+   for(page=0; page<GLYPH_PAGES; page++)
+   {
+      font->directory[page] = GLYPH_EMPTY_PAGE;
+   }
+   font->directory[0] = GLYPH_LATIN1_PAGE;
+   for(i=0; i<count; i++)
+   {
+      page = letters[i].code/GLYPH_PAGE_SIZE;
+      if(font->directory[page] == GLYPH_EMPTY_PAGE)
+      {
+         font->directory[page] = font->pages++;
+      }
+   }
+
+   font->glyphs = (glyph_t *)calloc((size_t)font->pages*GLYPH_PAGE_SIZE, sizeof(glyph_t));
+   rows = (const char *const **)calloc((size_t)font->pages*GLYPH_PAGE_SIZE, sizeof(const char *const *));
+   if(font->glyphs == NULL || rows == NULL)
+   {
+      free(font->directory);
+      free(font->glyphs);
+      free(rows);
+      return(0);
+   }
+
+   for(page=0; page<GLYPH_PAGES; page++)
+   {
+      for(i=0; i<GLYPH_PAGE_SIZE && font->directory[page] != GLYPH_EMPTY_PAGE; i++)
+      {
+         FONT_GLYPH(font, page*GLYPH_PAGE_SIZE + i)->code = page*GLYPH_PAGE_SIZE + i;
+      }
+   }
+
+   for(i=0; i<count; i++)
+   {
+      glyph = FONT_GLYPH(font, letters[i].code);
+      glyph->present = 1;
+      rows[glyph - font->glyphs] = letters[i].rows;
+   }
+
+   for(i=0; i<font->pages*GLYPH_PAGE_SIZE; i++)
+   {
+      glyph = &font->glyphs[i];
+      if(glyph->present)
+      {
+         glyph->width = strlen(rows[i][0]);
+         glyph->offset = width;
+         width += glyph->width;
+      }
+   }
+
+   font->stride = width;
+   packed = pack_bitmap(font, rows) || pack_atlas(font, rows);
+   free(rows);
+   if(!packed)
+   {
+      free(font->directory);
+      free(font->glyphs);
+      return(0);
+   }
+
+   for(page=0; page<GLYPH_PAGES; page++)
+   {
+      for(i=0; i<GLYPH_PAGE_SIZE && font->directory[page] != GLYPH_EMPTY_PAGE; i++)
+      {
+         code = page*GLYPH_PAGE_SIZE + i;
+         glyph = FONT_GLYPH(font, code);
+         target = fold_code(code);
+         folded = FONT_GLYPH(font, target);
+         if(!glyph->present && folded->present)
+         {
+            *glyph = *folded;
+         }
+      }
+   }
+
+   banner_set_advances(font);
+   return(1);
+}
+
+
+/********************************
+  banner_set_advances subroutine
+ ********************************/
+/** Fills in a font's @c advance table from its glyph table.
+  * Measuring and wrapping only need to know how far each Latin-1 character
+  * moves along the line, so they look it up here rather than in the glyph
+  * table.  Other characters are rare enough to look up in the glyph table.
+  * @param font      Font to fill in
+  */
+
+void banner_set_advances(banner_font_t *font)
+{
+   int i = 0;
+   const glyph_t *glyph = NULL;
+
+   for(i=0; i<GLYPH_PAGE_SIZE; i++)
+   {
+      glyph = &font->glyphs[GLYPH_LATIN1_PAGE*GLYPH_PAGE_SIZE + i];
+      font->advance[i] = glyph->present ? glyph->width + font->space : 0;
+   }
+}
+
+
+/**************************
+  banner_decode subroutine
+ **************************/
+/** Decodes the UTF-8 character at a position in a string.
+  * @param string    String to decode
+  * @param length    Length of the string
+  * @param position  Position of the character, updated to the one after it
+  * @return Character, as a code point.
+  */
+
+int32_t banner_decode(const char *string, size_t length, size_t *position)
+{
+   const unsigned char *bytes = (const unsigned char *)string + *position;
+   size_t left = length - *position;
+   int32_t code = 0;
+   int32_t minimum = 0;
+   int count = 0;
+   int i = 0;
+
+   if(bytes[0] >= 0xC2 && bytes[0] <= 0xDF)
+   {
+      count = 1;
+      code = bytes[0] & 0x1F;
+      minimum = 0x80;
+   }
+   else if(bytes[0] >= 0xE0 && bytes[0] <= 0xEF)
+   {
+      count = 2;
+      code = bytes[0] & 0x0F;
+      minimum = 0x800;
+   }
+   else if(bytes[0] >= 0xF0 && bytes[0] <= 0xF4)
+   {
+      count = 3;
+      code = bytes[0] & 0x07;
+      minimum = 0x10000;
+   }
+
+   if(count == 0 || left <= (size_t)count)
+   {
+      (*position)++;
+      return(bytes[0]);   /* ASCII, or Latin-1 */
+   }
+
+   for(i=1; i<=count; i++)
+   {
+      if((bytes[i] & 0xC0) != 0x80)
+      {
+         (*position)++;
+         return(bytes[0]);
+      }
+      code = (code << 6) | (bytes[i] & 0x3F);
+   }
+
+   if(code < minimum || code > 0x10FFFF || (code >= 0xD800 && code <= 0xDFFF))
+   {
+      (*position)++;
+      return(bytes[0]);
+   }
+
+   *position += count + 1;
+   return(code);
+}
+
+
+/****************************
+  banner_is_ascii subroutine
+ ****************************/
+/** Checks whether a string is all ASCII, eight bytes at a time.
+  * @param string    String to check
+  * @param length    Length of the string
+  * @return Boolean true (1) if every byte is below 0x80, boolean false (0) otherwise.
+  */
+
+int banner_is_ascii(const char *string, size_t length)
+{
+   uint64_t word = 0;
+   uint64_t bits = 0;
+   size_t j = 0;
+
+   for(j=0; j+sizeof(word)<=length; j+=sizeof(word))
+   {
+      memcpy(&word, string + j, sizeof(word));
+      bits |= word;
+   }
+   for(; j<length; j++)
+   {
+      bits |= (unsigned char)string[j];
+   }
+
+   return((bits & UINT64_C(0x8080808080808080)) == 0);
+}
+
+
+/****************************
+  banner_complete subroutine
+ ****************************/
+/** Works out how much of a block of text ends on a whole character.
+  * @param string    Block of text
+  * @param length    Length of the block
+  * @return Length of the block without any UTF-8 sequence cut off at its end.
+  */
+
+size_t banner_complete(const char *string, size_t length)
+{
+   size_t back = 0;
+   unsigned char c = 0;
+
+   for(back=1; back<=3 && back<=length; back++)
+   {
+      c = (unsigned char)string[length - back];
+      if((c & 0xC0) != 0x80)
+      {
+         if((c >= 0xC2 && c <= 0xDF && back < 2) || (c >= 0xE0 && c <= 0xEF && back < 3)
+            || (c >= 0xF0 && c <= 0xF4 && back < 4))
+         {
+            return(length - back);   /* the rest of it is still to come */
+         }
+         break;
+      }
+   }
+
+   return(length);
+}
+
+
+/************************
+  init_glyphs subroutine
+ ************************/
+/** Sets up the built-in font from the letters in letters.h.
+  * If there isn't enough memory, the built-in font's bitmap and atlas are
+  * both left NULL.
+  */
+
+static void init_glyphs(void)
+{
+   banner_pack_font(&builtin_font, builtin_letters, sizeof(builtin_letters)/sizeof(builtin_letters[0]));
+}
+
+
+/***********************
+  next_glyph subroutine
+ ***********************/
+/** Looks up the glyph for the next character of a string.
+  * @param font      Font to look in
+  * @param string    String to look at
+  * @param length    Length of the string
+  * @param position  Position of the character, updated to the one after it
+  * @return Glyph for the character, which isn't present if the font doesn't define it.
+  */
+
+static const glyph_t *next_glyph(const banner_font_t *font, const char *string, size_t length, size_t *position)
+{
+   unsigned char c = (unsigned char)string[*position];
+   int32_t code = 0;
+
+   if(c < 0x80)
+   {
+      (*position)++;
+      return(&font->glyphs[c]);
+   }
+
+   code = banner_decode(string, length, position);
+   return(FONT_GLYPH(font, code));
+}
+
+
+/***************************
+  measure_banner subroutine
+ ***************************/
+/** Works out how much of a string will fit into a banner.
+  * Characters that aren't defined take up no space.  Once a letter doesn't
+  * fit, the rest of the string is dropped, even if later letters are narrower.
+  * ASCII characters are measured from the @c advance table without looking
+  * at the glyph table, and anything else is decoded first.
+  * @param font      Font to draw the banner in
+  * @param string    String to be measured, which need not be null-terminated
+  * @param length    Length of the string
+  * @param maxwidth  Maximum width of any one banner line, including the newline
+  * @param metrics   Returns the number of bytes, characters and glyphs that fit
+  * @return Width (in characters) of each banner line, not including the newline.
+  */
+
+static int measure_banner(const banner_font_t *font, const char *string, size_t length, int maxwidth,
+                          banner_metrics_t *metrics)
+{
+   size_t j = 0;
+   size_t next = 0;
+   size_t characters = 0;
+   size_t drawn = 0;
+   int width = 0;
+   int advance = 0;
+   unsigned char c = 0;
+   const glyph_t *glyph = NULL;
+
+   for(j=0; j<length; j=next)
+   {
+      next = j;
+      c = (unsigned char)string[j];
+      if(c < 0x80)
+      {
+         advance = font->advance[c];
+         next++;
+      }
+      else
+      {
+         glyph = next_glyph(font, string, length, &next);
+         advance = glyph->present ? glyph->width + font->space : 0;
+      }
+
+      if(advance > 0)
+      {
+         if(advance >= maxwidth - width)
+         {
+            break;   /* banner will be truncated */
+         }
+
+         width += advance;
+         drawn++;
+      }
+      characters++;
+   }
+
+   metrics->consumed = j;
+   metrics->glyphs = drawn;
+   metrics->unknown = characters - drawn;
+   return(width);
+}
+
+
+/**************************
+  count_dropped subroutine
+ **************************/
+/** Works out how much of a string was dropped from the end of a banner.
+  * Whitespace that only trails the banner isn't counted, since nothing
+  * would have been drawn for it anyway.
+  * @param string    String that was measured
+  * @param length    Length of the string
+  * @param consumed  Number of bytes of the string that fit
+  * @return Number of bytes dropped, or zero if the rest is whitespace.
+  */
+
+static size_t count_dropped(const char *string, size_t length, size_t consumed)
+{
+   size_t j = 0;
+   size_t next = 0;
+
+   for(j=consumed; j<length; j=next)
+   {
+      next = j;
+      if(!is_space(banner_decode(string, length, &next)))
+      {
+         return(length - consumed);
+      }
+   }
+
+   return(0);
+}
+
+
+/**************************
+  add_to_banner subroutine
+ **************************/
+/** Writes a letter into a banner buffer at a known offset.
+  * The buffer must already be big enough to hold the letter and its spacing.
+  * @param font      Font to draw the letter in
+  * @param buffer    Banner buffer
+  * @param stride    Distance between the start of each banner line
+  * @param glyph     Glyph of the letter to be added to the banner buffer
+  * @param offset    Offset within each banner line to write the letter at
+  * @return Offset just past the letter and its spacing.
+  */
+
+static int add_to_banner(const banner_font_t *font, char *buffer, int stride, const glyph_t *glyph, int offset)
+{
+   int i = 0;
+   const char *row = NULL;
+   char *line = NULL;
+
+   if(!glyph->present)
+   {
+      /* If we don't know about it, we'll just ignore it. */
+      return(offset);
+   }
+
+   row = font->atlas + glyph->offset;
+   line = buffer + offset;
+   for(i=0; i<font->height; i++)
+   {
+      memcpy(line, row, glyph->width);
+      memset(line + glyph->width, ' ', font->space);
+      row += font->stride;
+      line += stride;
+   }
+
+   return(offset + glyph->width + font->space);
+}
+
+
+/***********************
+  glyph_bits subroutine
+ ***********************/
+/** Pulls the bits for one row of a glyph out of a bitmap row.
+  * @param row       Bitmap row to look in
+  * @param glyph     Glyph to pull the bits for
+  * @return Bits for the glyph's row, lowest (leftmost) first, with the rest clear.
+  */
+
+static uint64_t glyph_bits(const uint64_t *row, const glyph_t *glyph)
+{
+   int shift = glyph->offset % EXPAND_BITS;
+   uint64_t bits = 0;
+
+   row += glyph->offset/EXPAND_BITS;
+   bits = row[0] >> shift;
+   if(shift + glyph->width > EXPAND_BITS)
+   {
+      bits |= row[1] << (EXPAND_BITS - shift);
+   }
+   if(glyph->width < EXPAND_BITS)
+   {
+      bits &= ((uint64_t)1 << glyph->width) - 1;
+   }
+
+   return(bits);
+}
+
+
+/************************
+  append_bits subroutine
+ ************************/
+/** Adds bits to the end of a line, expanding them once there's a kernel's worth.
+  * @param font      Font the line is drawn in
+  * @param line      Line to add to
+  * @param bits      Bits to add, lowest (leftmost) first, with the rest clear
+  * @param count     Number of bits to add, no more than @c EXPAND_BITS
+  */
+
+static void append_bits(const banner_font_t *font, bitline_t *line, uint64_t bits, int count)
+{
+   int carry = 0;
+
+   line->bits |= bits << line->used;
+   line->used += count;
+   if(line->used >= EXPAND_BITS)
+   {
+      font->expand(line->out, line->bits, EXPAND_BITS, font->fill, font->blank);
+      line->out += EXPAND_BITS;
+      carry = line->used - EXPAND_BITS;
+      line->bits = carry > 0 ? bits >> (count - carry) : 0;
+      line->used = carry;
+   }
+}
+
+
+/**************************
+  render_bitmap subroutine
+ **************************/
+/** Renders a banner from a font's bitmap, one line at a time.
+  * Each line walks the whole string again, so a string that's all ASCII
+  * (which is checked once, up front) is looked up a byte at a time without
+  * decoding it.
+  * @param font      Font to draw the banner in, which must have a bitmap
+  * @param string    String to be rendered
+  * @param metrics   Dimensions of the banner
+  * @param buffer    Buffer to render into, at least @c metrics->size bytes
+  */
+
+static void render_bitmap(const banner_font_t *font, const char *string,
+                          const banner_metrics_t *metrics, char *buffer)
+{
+   int i = 0;
+   int ascii = 0;
+   size_t j = 0;
+   const uint64_t *row = NULL;
+   const glyph_t *glyph = NULL;
+   bitline_t line;
+
+   ascii = banner_is_ascii(string, metrics->consumed);
+   for(i=0; i<font->height; i++)
+   {
+      row = font->bitmap + i*font->words;
+      line.out = buffer + i*font->scale*(metrics->width + 1);
+      line.bits = 0;
+      line.used = 0;
+
+      j = 0;
+      while(j < metrics->consumed)
+      {
+         if(ascii)
+         {
+            glyph = &font->glyphs[(unsigned char)string[j++]];
+         }
+         else
+         {
+            glyph = next_glyph(font, string, metrics->consumed, &j);
+         }
+
+         if(glyph->present)
+         {
+            append_bits(font, &line, glyph_bits(row, glyph), glyph->width + font->space);
+         }
+      }
+
+      font->expand(line.out, line.bits, line.used, font->fill, font->blank);
+   }
+}
+
+
+/********************************
+  banner_builtin_font subroutine
+ ********************************/
+/** Returns the font compiled in from letters.h.
+  * @return Built-in font, or NULL if there wasn't enough memory to set it up.
+  */
+
+const banner_font_t *banner_builtin_font(void)
+{
+#ifdef HAVE_PTHREAD_H
+   pthread_once(&builtin_once, init_glyphs);
+#else
+   if(!builtin_once)
+   {
+      init_glyphs();
+      builtin_once = 1;
+   }
+#endif
+
+   return(builtin_font.bitmap != NULL || builtin_font.atlas != NULL ? &builtin_font : NULL);
+}
+
+
+/*******************************
+  banner_glyph_pixel subroutine
+ *******************************/
+/** Returns the character a font draws at one place in a glyph.
+  * @param font      Font the glyph is in
+  * @param glyph     Glyph to look in
+  * @param row       Row within the glyph
+  * @param column    Column within the glyph
+  * @return Character drawn there.
+  */
+
+char banner_glyph_pixel(const banner_font_t *font, const glyph_t *glyph, int row, int column)
+{
+   int bit = glyph->offset + column;
+
+   if(font->bitmap != NULL)
+   {
+      return((font->bitmap[row*font->words + bit/EXPAND_BITS] >> (bit % EXPAND_BITS)) & 1 ? font->fill : font->blank);
+   }
+
+   return(font->atlas[row*font->stride + bit]);
+}
+
+
+/*************************
+  free_letters subroutine
+ *************************/
+/** Frees letters made by scale_letters().
+  * @param letters   Letters to free, which may be NULL
+  * @param count     Number of letters
+  */
+
+static void free_letters(letter_t *letters, int count)
+{
+   int i = 0;
+
+   for(i=0; i<count && letters != NULL; i++)
+   {
+      free((void *)letters[i].rows);
+   }
+
+   free(letters);
+}
+
+
+/**************************
+  scale_letters subroutine
+ **************************/
+/** Widens each letter a font was made from, for a scaled copy of the font.
+  * The characters that were folded onto those letters are left out, since
+  * banner_pack_font() folds them again.  Each letter's rows are allocated
+  * in one block, with the row pointers first.
+  * @param font      Font to widen the letters of
+  * @param xscale    Number of times each column is drawn, side by side
+  * @param count     Returns the number of letters
+  * @return Letters, to be freed with free_letters(), or NULL if there wasn't enough memory.
+  */
+
+static letter_t *scale_letters(const banner_font_t *font, int xscale, int *count)
+{
+   int page = 0;
+   int i = 0;
+   int j = 0;
+   int k = 0;
+   int width = 0;
+   int32_t code = 0;
+   char *text = NULL;
+   const char **rows = NULL;
+   letter_t *letters = NULL;
+   const glyph_t *glyph = NULL;
+
+   *count = 0;
+   letters = (letter_t *)malloc((size_t)font->pages*GLYPH_PAGE_SIZE*sizeof(letter_t));
+   if(letters == NULL)
+   {
+      return(NULL);
+   }
+
+   for(page=0; page<GLYPH_PAGES; page++)
+   {
+      for(i=0; i<GLYPH_PAGE_SIZE && (page == 0 || font->directory[page] != GLYPH_EMPTY_PAGE); i++)
+      {
+         code = page*GLYPH_PAGE_SIZE + i;
+         glyph = FONT_GLYPH(font, code);
+         if(!glyph->present || glyph->code != code)
+         {
+            continue;   /* not defined, or folded onto another letter */
+         }
+
+         width = glyph->width*xscale;
+         rows = (const char **)malloc(font->height*(sizeof(char *) + width + 1));
+         if(rows == NULL)
+         {
+            free_letters(letters, *count);
+            return(NULL);
+         }
+
+         text = (char *)(rows + font->height);
+         for(j=0; j<font->height; j++)
+         {
+            rows[j] = text;
+            for(k=0; k<width; k++)
+            {
+               text[k] = banner_glyph_pixel(font, glyph, j, k/xscale);
+            }
+            text[width] = '\0';
+            text += width + 1;
+         }
+
+         letters[*count].code = code;
+         letters[*count].rows = rows;
+         (*count)++;
+      }
+   }
+
+   return(letters);
+}
+
+
+/******************************
+  banner_font_scale subroutine
+ ******************************/
+/** Makes a copy of a font that draws each letter bigger.
+  * @param font      Font to scale
+  * @param xscale    Number of times each column is drawn, side by side
+  * @param yscale    Number of times each row is drawn, one under another
+  * @return Scaled font, or NULL with errno set if it couldn't be made.
+  */
+
+const banner_font_t *banner_font_scale(const banner_font_t *font, int xscale, int yscale)
+{
+   int count = 0;
+   int packed = 0;
+   letter_t *letters = NULL;
+   banner_font_t *scaled = NULL;
+
+   if(xscale < 1 || yscale < 1 || font->stride + font->space > INT_MAX/xscale
+      || font->height*font->scale > INT_MAX/yscale)
+   {
+      errno = EINVAL;
+      return(NULL);
+   }
+
+   scaled = (banner_font_t *)calloc(1, sizeof(banner_font_t));
+   if(scaled == NULL)
+   {
+      errno = ENOMEM;
+      return(NULL);
+   }
+
+   scaled->height = font->height;
+   scaled->space = font->space*xscale;
+   scaled->blank = font->blank;
+   scaled->scale = font->scale*yscale;
+   scaled->owned = 1;
+
+   letters = scale_letters(font, xscale, &count);
+   packed = letters != NULL && banner_pack_font(scaled, letters, count);
+   free_letters(letters, count);
+   if(!packed)
+   {
+      free(scaled);
+      errno = ENOMEM;
+      return(NULL);
+   }
+
+   return(scaled);
+}
+
+
+/***************************
+  banner_measure subroutine
+ ***************************/
+/** Works out how much of a string fits into a banner, and how big it is.
+  * @param font      Font to draw the banner in
+  * @param string    String to be measured, which need not be null-terminated
+  * @param length    Length of the string
+  * @param maxwidth  Maximum width of any one banner line
+  * @param metrics   Returns the dimensions of the banner
+  */
+
+void banner_measure(const banner_font_t *font, const char *string, size_t length,
+                    int maxwidth, banner_metrics_t *metrics)
+{
+   metrics->width = measure_banner(font, string, length, maxwidth, metrics);
+   metrics->dropped = count_dropped(string, length, metrics->consumed);
+   metrics->height = font->height*font->scale;
+   metrics->size = (size_t)metrics->height*(metrics->width + 1);
+}
+
+
+/*****************************
+  banner_stats_add subroutine
+ *****************************/
+/** Adds a banner's dimensions to a set of counters.
+  * @param stats     Counters to add to
+  * @param metrics   Dimensions of the banner
+  */
+
+void banner_stats_add(banner_stats_t *stats, const banner_metrics_t *metrics)
+{
+   stats->banners++;
+   stats->consumed += metrics->consumed;
+   stats->glyphs += metrics->glyphs;
+   stats->unknown += metrics->unknown;
+   stats->truncated += metrics->dropped > 0;
+   stats->dropped += metrics->dropped;
+   stats->bytes += metrics->size;
+}
+
+
+/************************
+  banner_wrap subroutine
+ ************************/
+/** Works out where to break a string so that it wraps onto several banners.
+  * This is the same walk along the string as measure_banner(), which also
+  * notes where each word ends, so ASCII characters are looked up in the
+  * @c advance table and only anything else is decoded.  When a letter doesn't fit, the banner is
+  * broken after the last word that did.  If not even one whole word fit, the
+  * word is broken instead.  If not even the first letter fits, nothing would
+  * be gained by breaking the string at all, so the rest of it goes onto one
+  * banner that banner_measure() truncates.
+  * @param font      Font to draw the banners in
+  * @param string    String to be wrapped, which need not be null-terminated
+  * @param length    Length of the string
+  * @param maxwidth  Maximum width of any one banner line
+  * @param next      Returns where the rest of the string starts, past any whitespace
+  * @return Number of bytes of the string that go on the first banner.
+  */
+
+size_t banner_wrap(const banner_font_t *font, const char *string, size_t length, int maxwidth, size_t *next)
+{
+   size_t j = 0;
+   size_t after = 0;
+   size_t wordend = 0;
+   int width = 0;
+   int advance = 0;
+   int space = 0;
+   int previous = 1;
+   int32_t code = 0;
+   unsigned char c = 0;
+   const glyph_t *glyph = NULL;
+
+   for(j=0; j<length; j=after)
+   {
+      after = j;
+      c = (unsigned char)string[j];
+      if(c < 0x80)
+      {
+         space = is_space(c);
+         advance = font->advance[c];
+         after++;
+      }
+      else
+      {
+         code = banner_decode(string, length, &after);
+         space = is_space(code);
+         glyph = FONT_GLYPH(font, code);
+         advance = glyph->present ? glyph->width + font->space : 0;
+      }
+
+      if(space && !previous)
+      {
+         wordend = j;
+      }
+      previous = space;
+
+      if(advance > 0 && advance >= maxwidth - width)
+      {
+         break;   /* string has to be broken */
+      }
+      width += advance;
+   }
+
+   if(j == length || j == 0)
+   {
+      *next = length;
+      return(length);
+   }
+
+   if(wordend == 0)
+   {
+      *next = j;
+      return(j);
+   }
+
+   *next = wordend;
+   while(*next < length)
+   {
+      after = *next;
+      if(!is_space(banner_decode(string, length, &after)))
+      {
+         break;
+      }
+      *next = after;
+   }
+
+   return(wordend);
+}
+
+
+/**************************
+  banner_render subroutine
+ **************************/
+/** Renders a banner into a buffer.
+  * The final width of the banner is already known from banner_measure(), so
+  * each letter (or each line, from a bitmap) can be written straight into place.
+  * For a scaled font, only the first line of each group is rendered, and the
+  * rest of the group is copied from it.
+  * @param font      Font to draw the banner in
+  * @param string    String to be rendered, as passed to banner_measure()
+  * @param metrics   Dimensions of the banner, from banner_measure()
+  * @param buffer    Buffer to render into
+  * @param size      Size of the buffer
+  * @return Number of bytes written, or zero if the buffer was too small.
+  */
+
+size_t banner_render(const banner_font_t *font, const char *string,
+                     const banner_metrics_t *metrics, char *buffer, size_t size)
+{
+   int i = 0;
+   int k = 0;
+   size_t j = 0;
+   int offset = 0;
+   int stride = metrics->width + 1;
+   char *line = NULL;
+   const glyph_t *glyph = NULL;
+
+   if(size < metrics->size)
+   {
+      return(0);
+   }
+
+   if(font->bitmap != NULL)
+   {
+      render_bitmap(font, string, metrics, buffer);
+   }
+   else
+   {
+      j = 0;
+      while(j < metrics->consumed)
+      {
+         glyph = next_glyph(font, string, metrics->consumed, &j);
+         offset = add_to_banner(font, buffer, stride*font->scale, glyph, offset);
+      }
+   }
+
+   for(i=0; i<font->height; i++)
+   {
+      line = buffer + i*font->scale*stride;
+      line[metrics->width] = '\n';
+      for(k=1; k<font->scale; k++)
+      {
+         memcpy(line + k*stride, line, stride);
+      }
+   }
+
+   return(metrics->size);
+}
+
@@ -0,0 +1,304 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *
+ *              C E D A R
+ *          S O L U T I O N S       "Software done right."
+ *           S O F T W A R E
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *
+ * Copyright (c) 2000-2004,2007,2013,2014,2020,2024 Kenneth J. Pronovici.
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License,
+ * Version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Copies of the GNU General Public License are available from
+ * the Free Software Foundation website, http://www.gnu.org/.
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *
+ * Author   : Kenneth J. Pronovici <pronovic@ieee.org>
+ * Language : ANSI C
+ * Project  : banner
+ * Purpose  : Public interface to the banner rendering library.
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/********************
+  File documentation
+ ********************/
+
+/** @file
+  * @author Kenneth J. Pronovici
+  * @brief  Public interface to the banner rendering library.
+  *
+  * The library renders a string as a banner into a buffer supplied by the
+  * caller.  Rendering is a two-step process: banner_measure() works out how
+  * much of the string fits and how big the banner will be, and then
+  * banner_render() writes the banner into a buffer at least that big.
+  * Neither function allocates memory or touches any global state, so they
+  * may be called from any number of threads at once.
+  *
+  * Strings are UTF-8.  Any byte that doesn't start a valid UTF-8 sequence is
+  * taken to be a Latin-1 character on its own, so there are no invalid
+  * strings.  Lengths and positions within strings are always in bytes.
+  *
+  * A rendered banner is @c height lines of exactly @c width characters, each
+  * followed by a newline, so it can be written out as-is.  Line @c i starts
+  * at offset <tt>i*(width+1)</tt> within the buffer.
+  *
+  * Long-running callers that see the same strings over and over can put a
+  * cache in front of the renderer with banner_cache_render().  Unlike the
+  * renderer, the cache allocates memory, and it isn't safe to share one
+  * cache between threads without locking it.
+  */
+
+#ifndef LIBBANNER_H
+#define LIBBANNER_H
+/*{*/
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/******************
+  Type definitions
+ ******************/
+
+/** A font that banners are drawn in.  The contents are private. */
+typedef struct banner_font banner_font_t;
+
+/** A font turned on its side, for vertical banners.  The contents are private. */
+typedef struct banner_vertical banner_vertical_t;
+
+/** A cache of rendered banners.  The contents are private. */
+typedef struct banner_cache banner_cache_t;
+
+/** Counters describing how well a cache is doing. */
+typedef struct
+{
+   unsigned long hits;        /**< Number of banners found in the cache */
+   unsigned long misses;      /**< Number of banners that had to be rendered */
+   unsigned long evictions;   /**< Number of banners dropped to stay under the limit */
+   unsigned long entries;     /**< Number of banners in the cache now */
+   size_t bytes;              /**< Memory used by the cache now, in bytes */
+   size_t limit;              /**< Limit on the memory used by the cache, in bytes */
+   unsigned long allocations; /**< Number of allocations the cache has made */
+   size_t allocated;          /**< Total size of those allocations, in bytes */
+} banner_cache_stats_t;
+
+/** Dimensions of a banner, as worked out by banner_measure(). */
+typedef struct
+{
+   int width;           /**< Width of each line, not including the newline */
+   int height;          /**< Number of lines */
+   size_t consumed;     /**< Number of bytes of the string that fit */
+   size_t glyphs;       /**< Number of those characters that are drawn */
+   size_t unknown;      /**< Number of those characters skipped, since the font doesn't define them */
+   size_t dropped;      /**< Number of bytes of the string left off the end, unless they're all whitespace */
+   size_t size;         /**< Size of the rendered banner, in bytes */
+} banner_metrics_t;
+
+/** Counters accumulated over many banners with banner_stats_add(). */
+typedef struct
+{
+   unsigned long banners;     /**< Number of banners */
+   unsigned long consumed;    /**< Number of bytes that fit */
+   unsigned long glyphs;      /**< Number of characters drawn */
+   unsigned long unknown;     /**< Number of characters skipped, since the font doesn't define them */
+   unsigned long truncated;   /**< Number of banners that didn't fit and were truncated */
+   unsigned long dropped;     /**< Number of bytes left off the end of truncated banners */
+   unsigned long bytes;       /**< Total size of the banners, in bytes */
+} banner_stats_t;
+
+
+/***********************
+  Function declarations
+ ***********************/
+
+/** Returns the font compiled in from letters.h.
+  * The font is set up the first time this is called, which is safe to do
+  * from several threads at once.
+  * @return Built-in font, or NULL if there wasn't enough memory to set it up.
+  */
+extern const banner_font_t *banner_builtin_font(void);
+
+/** Opens a font compiled by banner-fontc.
+  * The font file is mapped into memory and used as-is, so opening a font
+  * takes the same (short) time no matter how big the font is.
+  * @param path      Path of the compiled font file
+  * @return Font, or NULL with errno set if the file couldn't be mapped or isn't
+  *         a compiled font for this machine (EINVAL).
+  */
+extern const banner_font_t *banner_font_open(const char *path);
+
+/** Closes a font opened by banner_font_open() or made by banner_font_scale().
+  * Nothing may use the font afterwards, including any cache that has banners
+  * drawn in it.  Closing the built-in font does nothing.
+  * @param font      Font to close, which may be NULL
+  */
+extern void banner_font_close(const banner_font_t *font);
+
+/** Makes a copy of a font that draws each letter bigger.
+  * Each letter is widened once, here, so a scaled font draws as quickly as
+  * any other, and rows are drawn once and then copied for the rest of their
+  * height.  The original font may be closed once the copy has been made.
+  * @param font      Font to scale
+  * @param xscale    Number of times each column is drawn, side by side
+  * @param yscale    Number of times each row is drawn, one under another
+  * @return Scaled font, to be closed with banner_font_close(), or NULL with
+  *         errno set if a scale is less than 1 or too big (EINVAL) or there
+  *         wasn't enough memory.
+  */
+extern const banner_font_t *banner_font_scale(const banner_font_t *font, int xscale, int yscale);
+
+/** Works out how much of a string fits into a banner, and how big it is.
+  * Lower-case letters (in Latin-1, Latin Extended-A, Greek and Cyrillic) are
+  * drawn as upper-case, whitespace is drawn as spaces, and characters that
+  * the font doesn't define are skipped.  Once a letter
+  * doesn't fit, the rest of the string is dropped, looking no further than
+  * its first non-whitespace character, so a huge string costs no more to
+  * measure (or render) than the part of it that's visible.  Lines are kept narrower than @c maxwidth, so they never
+  * reach the last column of a terminal.
+  * @param font      Font to draw the banner in
+  * @param string    String to be measured, which need not be null-terminated
+  * @param length    Length of the string
+  * @param maxwidth  Maximum width of any one banner line, as described above
+  * @param metrics   Returns the dimensions of the banner
+  */
+extern void banner_measure(const banner_font_t *font, const char *string, size_t length,
+                           int maxwidth, banner_metrics_t *metrics);
+
+/** Adds a banner's dimensions to a set of counters.
+  * The counters must be zeroed before the first banner is added.  Like the
+  * rest of the renderer, this touches nothing but its arguments, so each
+  * thread can keep counters of its own and add them up afterwards.
+  * @param stats     Counters to add to
+  * @param metrics   Dimensions of the banner, from banner_measure() or banner_cache_render()
+  */
+extern void banner_stats_add(banner_stats_t *stats, const banner_metrics_t *metrics);
+
+/** Works out where to break a string so that it wraps onto several banners.
+  * Rather than truncating a string that doesn't fit, a caller can render it
+  * as a stack of banners, one after another.  Each call finds the characters
+  * for the next banner, breaking at whitespace between words if possible.
+  * Those characters are rendered as usual, with banner_measure() and
+  * banner_render(), and the rest of the string is wrapped the same way until
+  * none is left.  A word that's too wide for a banner on its own is broken,
+  * but if not even its first letter fits, the rest of the string goes onto
+  * one banner that banner_measure() truncates.
+  * @param font      Font to draw the banners in
+  * @param string    String to be wrapped, which need not be null-terminated
+  * @param length    Length of the string
+  * @param maxwidth  Maximum width of any one banner line, as for banner_measure()
+  * @param next      Returns where the rest of the string starts, past any whitespace;
+  *                  if this is @c length, the whole string fits
+  * @return Number of bytes of the string that go on the first banner, which
+  *         always ends on a whole character.
+  */
+extern size_t banner_wrap(const banner_font_t *font, const char *string, size_t length, int maxwidth, size_t *next);
+
+/** Renders a banner into a buffer.
+  * @param font      Font to draw the banner in
+  * @param string    String to be rendered, as passed to banner_measure()
+  * @param metrics   Dimensions of the banner, from banner_measure()
+  * @param buffer    Buffer to render into
+  * @param size      Size of the buffer, which must be at least @c metrics->size
+  * @return Number of bytes written, or zero if the buffer was too small.
+  */
+extern size_t banner_render(const banner_font_t *font, const char *string,
+                            const banner_metrics_t *metrics, char *buffer, size_t size);
+
+/** Works out how much of a block of text ends on a whole character.
+  * Text read a block at a time can end partway through a UTF-8 character.
+  * The bytes after this length should be kept, and put in front of the next
+  * block, unless there is no next block.
+  * @param string    Block of text
+  * @param length    Length of the block
+  * @return Length of the block without any UTF-8 sequence cut off at its end.
+  */
+extern size_t banner_complete(const char *string, size_t length);
+
+/** Turns a font on its side, for printing banners down the page.
+  * Each letter is turned once, here, into the lines that print it, with the
+  * top of the letter on the right, the way a line-printer banner is read.
+  * Lines are kept narrower than @c maxwidth, with the tops of the letters
+  * cut off if they have to be.
+  * @param font      Font to turn, which must stay open while this is used
+  * @param maxwidth  Maximum width of any one line, as for banner_measure()
+  * @return Font turned on its side, or NULL if there wasn't enough memory.
+  */
+extern banner_vertical_t *banner_vertical_create(const banner_font_t *font, int maxwidth);
+
+/** Frees a font turned on its side by banner_vertical_create().
+  * @param vertical  Font to free, which may be NULL
+  */
+extern void banner_vertical_destroy(banner_vertical_t *vertical);
+
+/** Renders as much of a string as fits into a buffer, as a vertical banner.
+  * Each character is drawn as whole lines, one after another, so there's no
+  * limit to how long the string can be; a caller can write the buffer out
+  * and call this again for the rest.  Characters are folded and skipped as
+  * for banner_measure().  Nothing is allocated, so this may be called from
+  * any number of threads at once.
+  * @param vertical  Font turned on its side
+  * @param string    String to be rendered, which need not be null-terminated
+  * @param length    Length of the string
+  * @param position  Where to start in the string, updated to where to carry on
+  * @param buffer    Buffer to render into
+  * @param size      Size of the buffer
+  * @return Number of bytes written, which is zero only if the string is used
+  *         up or the next character doesn't fit in the buffer.
+  */
+extern size_t banner_vertical_render(const banner_vertical_t *vertical, const char *string, size_t length,
+                                     size_t *position, char *buffer, size_t size);
+
+/** Creates an empty cache of rendered banners.
+  * @param limit     Limit on the memory used by the cache, in bytes
+  * @return New cache, or NULL if there wasn't enough memory.
+  */
+extern banner_cache_t *banner_cache_create(size_t limit);
+
+/** Frees a cache created by banner_cache_create(), and everything in it.
+  * @param cache     Cache to free, which may be NULL
+  */
+extern void banner_cache_destroy(banner_cache_t *cache);
+
+/** Returns a rendered banner, from the cache if possible.
+  * Banners are cached by font and by the letters that fit in the width, so
+  * strings that only differ by case, by whitespace characters, by undefined
+  * characters or by how much gets truncated all share an entry.  The least
+  * recently used banners are dropped whenever the cache goes over its limit.
+  * @param cache     Cache to look in
+  * @param font      Font to draw the banner in
+  * @param string    String to be rendered, which need not be null-terminated
+  * @param length    Length of the string
+  * @param maxwidth  Maximum width of any one banner line, as for banner_measure()
+  * @param metrics   Returns the dimensions of the banner, as from banner_measure()
+  * @return Rendered banner, @c metrics->size bytes long, which is valid until the
+  *         cache is next used, or NULL if there wasn't enough memory to render it.
+  */
+extern const char *banner_cache_render(banner_cache_t *cache, const banner_font_t *font,
+                                       const char *string, size_t length, int maxwidth,
+                                       banner_metrics_t *metrics);
+
+/** Returns the counters for a cache.
+  * @param cache     Cache to report on
+  * @param stats     Returns the counters
+  */
+extern void banner_cache_stats(const banner_cache_t *cache, banner_cache_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+/*}*/
+#endif /* ifndef LIBBANNER_H */
@@ -0,0 +1,386 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *
+ *              C E D A R
+ *          S O L U T I O N S       "Software done right."
+ *           S O F T W A R E
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *
+ * Copyright (c) 2000-2004,2007,2013,2014,2020,2024 Kenneth J. Pronovici.
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License,
+ * Version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Copies of the GNU General Public License are available from
+ * the Free Software Foundation website, http://www.gnu.org/.
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *
+ * Author   : Kenneth J. Pronovici <pronovic@ieee.org>
+ * Language : ANSI C
+ * Project  : banner
+ * Purpose  : Hardware performance counters for --profile.
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/********************
+  File documentation
+ ********************/
+
+/** @file
+  * @author Kenneth J. Pronovici
+  * @brief  Hardware performance counters for --profile.
+  *
+  * The counters are opened as a single perf_event_open() group, led by the
+  * cycle counter, so they are all scheduled onto the CPU together and can be
+  * read with a single read().  Only user-space events are counted, which is
+  * all that an unprivileged process is normally allowed, and which keeps the
+  * cost of reading the counters out of the counts.  Events that the CPU (or
+  * a virtual machine) doesn't provide are left out of the group and reported
+  * as "-" rather than making the whole profile fail.
+  *
+  * Each phase change reads the group and charges everything counted since
+  * the last change to the phase that was going on, so the counts add up to
+  * the whole run no matter how often phases change.
+  */
+
+
+/****************
+  Included files
+ ****************/
+
+#include "config.h"
+
+#include <stdio.h>
+
+#ifdef HAVE_STDLIB_H
+   #include <stdlib.h>
+#endif
+
+#ifdef HAVE_STRING_H
+   #include <string.h>
+#endif
+
+#include <errno.h>
+#include <stdint.h>
+#include <unistd.h>
+
+#ifdef HAVE_LINUX_PERF_EVENT_H
+   #include <linux/perf_event.h>
+   #include <sys/ioctl.h>
+   #include <sys/syscall.h>
+#endif
+
+#include "profile.h"
+
+
+/******************
+  Macro defintions
+ *******************/
+
+#if defined(HAVE_LINUX_PERF_EVENT_H) && defined(SYS_perf_event_open)
+/** Hardware counters can be opened on this platform */
+#define HAVE_PROFILE
+#endif
+
+/** Number of events counted */
+#define PROFILE_EVENTS  (4)
+
+
+/******************
+  Type definitions
+ ******************/
+
+/** A set of hardware counters, split between phases. */
+struct profile
+{
+   int leader;                      /**< Descriptor of the group leader, which is read */
+   int fds[PROFILE_EVENTS];         /**< Descriptor of each event, or -1 if it isn't counted */
+   int slots[PROFILE_EVENTS];       /**< Position of each event's value in a group read, or -1 */
+   int opened;                      /**< Number of events in the group */
+   int phases;                      /**< Number of phases, not including "other" */
+   int current;                     /**< Phase being counted, or @c phases for "other" */
+   uint64_t last[PROFILE_EVENTS];   /**< Values read at the last phase change */
+   uint64_t *counts;                /**< Counts for each phase and "other", PROFILE_EVENTS per row */
+   int *entered;                    /**< Boolean true (1) for each phase that was ever entered */
+};
+
+
+/******************
+  Global variables
+ ******************/
+
+/** Names of the events, as printed in the table */
+static const char *event_names[PROFILE_EVENTS] = { "cycles", "instructions", "cache-misses", "branch-misses" };
+
+#ifdef HAVE_PROFILE
+
+/** Hardware event counted for each of the events above */
+static const uint64_t event_configs[PROFILE_EVENTS] =
+{
+   PERF_COUNT_HW_CPU_CYCLES,
+   PERF_COUNT_HW_INSTRUCTIONS,
+   PERF_COUNT_HW_CACHE_MISSES,
+   PERF_COUNT_HW_BRANCH_MISSES
+};
+
+
+/***********************
+  open_event subroutine
+ ***********************/
+/** Opens a counter for one hardware event in the calling thread.
+  * @param config    Hardware event to count
+  * @param group     Descriptor of the group leader, or -1 to open a new group
+  * @return Descriptor of the counter, or -1 with errno set.
+  */
+
+static int open_event(uint64_t config, int group)
+{
+   struct perf_event_attr attr;
+
+   memset(&attr, 0, sizeof(attr));
+   attr.size = sizeof(attr);
+   attr.type = PERF_TYPE_HARDWARE;
+   attr.config = config;
+   attr.read_format = PERF_FORMAT_GROUP;
+   attr.disabled = group < 0;   /* the group starts once it's complete */
+   attr.exclude_kernel = 1;
+   attr.exclude_hv = 1;
+
+   return((int)syscall(SYS_perf_event_open, &attr, 0, -1, group, 0));
+}
+
+#endif /* HAVE_PROFILE */
+
+
+/************************
+  read_events subroutine
+ ************************/
+/** Reads the current value of every event in the group.
+  * @param profile   Profile to read
+  * @param values    Returns the value of each event, zero if it isn't counted
+  */
+
+static void read_events(const profile_t *profile, uint64_t *values)
+{
+   uint64_t buffer[PROFILE_EVENTS + 1];
+   int i = 0;
+
+   if(read(profile->leader, buffer, sizeof(buffer)) < (ssize_t)((profile->opened + 1)*sizeof(uint64_t)))
+   {
+      memset(buffer, 0, sizeof(buffer));
+   }
+
+   for(i=0; i<PROFILE_EVENTS; i++)
+   {
+      values[i] = profile->slots[i] >= 0 ? buffer[1 + profile->slots[i]] : 0;
+   }
+}
+
+
+/*************************
+  profile_open subroutine
+ *************************/
+/** Starts counting in the calling thread.
+  * Events are added to the group in order, and the first one that opens
+  * leads it.  The profile only fails if none of them can be opened.
+  * @param phases    Number of phases
+  * @return Profile, or NULL with errno set.
+  */
+
+profile_t *profile_open(int phases)
+{
+#ifdef HAVE_PROFILE
+   profile_t *profile = NULL;
+   int error = 0;
+   int i = 0;
+
+   profile = (profile_t *)calloc(1, sizeof(profile_t));
+   if(profile == NULL)
+   {
+      return(NULL);
+   }
+
+   profile->leader = -1;
+   for(i=0; i<PROFILE_EVENTS; i++)
+   {
+      profile->slots[i] = -1;
+   }
+
+   profile->counts = (uint64_t *)calloc((size_t)(phases + 1)*PROFILE_EVENTS, sizeof(uint64_t));
+   profile->entered = (int *)calloc(phases + 1, sizeof(int));
+   if(profile->counts == NULL || profile->entered == NULL)
+   {
+      profile_close(profile);
+      errno = ENOMEM;
+      return(NULL);
+   }
+
+   profile->phases = phases;
+   profile->current = phases;
+   for(i=0; i<PROFILE_EVENTS; i++)
+   {
+      profile->fds[i] = open_event(event_configs[i], profile->leader);
+      if(profile->fds[i] < 0)
+      {
+         error = errno;
+         continue;   /* not counted on this CPU */
+      }
+
+      if(profile->leader < 0)
+      {
+         profile->leader = profile->fds[i];
+      }
+      profile->slots[i] = profile->opened++;
+   }
+
+   if(profile->leader < 0)
+   {
+      profile_close(profile);
+      errno = error;
+      return(NULL);
+   }
+
+   ioctl(profile->leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+   read_events(profile, profile->last);
+   return(profile);
+#else
+   (void)phases;
+   errno = ENOSYS;
+   return(NULL);
+#endif
+}
+
+
+/**************************
+  profile_enter subroutine
+ **************************/
+/** Starts a phase, charging everything counted since the last phase change
+  * to the phase that was going on.
+  * @param profile   Profile to update
+  * @param phase     Phase that starts now, or @c profile->phases for "other"
+  */
+
+void profile_enter(profile_t *profile, int phase)
+{
+   uint64_t values[PROFILE_EVENTS];
+   uint64_t *counts = NULL;
+   int i = 0;
+
+   read_events(profile, values);
+
+   counts = profile->counts + (size_t)profile->current*PROFILE_EVENTS;
+   for(i=0; i<PROFILE_EVENTS; i++)
+   {
+      counts[i] += values[i] - profile->last[i];
+      profile->last[i] = values[i];
+   }
+
+   profile->entered[phase] = 1;
+   profile->current = phase;
+}
+
+
+/**************************
+  profile_leave subroutine
+ **************************/
+/** Ends the current phase, so that what follows is counted as "other".
+  * @param profile   Profile to update
+  */
+
+void profile_leave(profile_t *profile)
+{
+   profile_enter(profile, profile->phases);
+}
+
+
+/**************************
+  profile_print subroutine
+ **************************/
+/** Prints a table of the counts for each phase that was ever entered, and
+  * for "other", with the instructions per cycle worked out for each.
+  * @param profile   Profile to print
+  * @param stream    Stream to print to
+  * @param names     Name of each phase
+  */
+
+void profile_print(const profile_t *profile, FILE *stream, const char *const *names)
+{
+   const uint64_t *counts = NULL;
+   int phase = 0;
+   int i = 0;
+
+   fprintf(stream, "%-10s", "phase");
+   for(i=0; i<PROFILE_EVENTS; i++)
+   {
+      fprintf(stream, " %15s", event_names[i]);
+   }
+   fprintf(stream, " %7s\n", "IPC");
+
+   for(phase=0; phase<=profile->phases; phase++)
+   {
+      if(phase < profile->phases && !profile->entered[phase])
+      {
+         continue;
+      }
+
+      counts = profile->counts + (size_t)phase*PROFILE_EVENTS;
+      fprintf(stream, "%-10s", phase < profile->phases ? names[phase] : "other");
+      for(i=0; i<PROFILE_EVENTS; i++)
+      {
+         if(profile->slots[i] >= 0)
+         {
+            fprintf(stream, " %15llu", (unsigned long long)counts[i]);
+         }
+         else
+         {
+            fprintf(stream, " %15s", "-");
+         }
+      }
+
+      if(profile->slots[0] >= 0 && profile->slots[1] >= 0 && counts[0] > 0)
+      {
+         fprintf(stream, " %7.2f\n", (double)counts[1]/counts[0]);
+      }
+      else
+      {
+         fprintf(stream, " %7s\n", "-");
+      }
+   }
+}
+
+
+/**************************
+  profile_close subroutine
+ **************************/
+/** Stops counting, and frees a profile.
+  * @param profile   Profile to close, which may be NULL
+  */
+
+void profile_close(profile_t *profile)
+{
+   int i = 0;
+
+   if(profile == NULL)
+   {
+      return;
+   }
+
+   for(i=0; i<PROFILE_EVENTS; i++)
+   {
+      if(profile->slots[i] >= 0)
+      {
+         close(profile->fds[i]);
+      }
+   }
+
+   free(profile->counts);
+   free(profile->entered);
+   free(profile);
+}
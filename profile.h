@@ -0,0 +1,98 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *
+ *              C E D A R
+ *          S O L U T I O N S       "Software done right."
+ *           S O F T W A R E
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *
+ * Copyright (c) 2000-2004,2007,2013,2014,2020,2024 Kenneth J. Pronovici.
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License,
+ * Version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Copies of the GNU General Public License are available from
+ * the Free Software Foundation website, http://www.gnu.org/.
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *
+ * Author   : Kenneth J. Pronovici <pronovic@ieee.org>
+ * Language : ANSI C
+ * Project  : banner
+ * Purpose  : Hardware performance counters for --profile.
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/********************
+  File documentation
+ ********************/
+
+/** @file
+  * @author Kenneth J. Pronovici
+  * @brief  Hardware performance counters for --profile.
+  *
+  * A profile counts CPU cycles, instructions, cache misses and branch misses
+  * in the calling thread, and splits the counts between phases of the
+  * program.  The caller marks where each phase starts with profile_enter()
+  * and where it ends with profile_leave(); whatever is counted outside any
+  * phase is reported as "other".  Profiles are only available on Linux,
+  * through perf_event_open().
+  */
+
+#ifndef PROFILE_H
+#define PROFILE_H
+/*{*/
+
+#include <stdio.h>
+
+
+/******************
+  Type definitions
+ ******************/
+
+/** A set of hardware counters, split between phases.  The contents are private. */
+typedef struct profile profile_t;
+
+
+/***********************
+  Function declarations
+ ***********************/
+
+/** Starts counting in the calling thread.
+  * @param phases    Number of phases, which are numbered from zero
+  * @return Profile, or NULL with errno set if the counters couldn't be opened
+  *         (ENOSYS if the platform doesn't have them at all).
+  */
+extern profile_t *profile_open(int phases);
+
+/** Starts a phase, ending whichever phase was going on.
+  * @param profile   Profile to update
+  * @param phase     Phase that starts now
+  */
+extern void profile_enter(profile_t *profile, int phase);
+
+/** Ends the current phase, if any.
+  * @param profile   Profile to update
+  */
+extern void profile_leave(profile_t *profile);
+
+/** Prints a table of the counts for each phase that was ever entered.
+  * @param profile   Profile to print
+  * @param stream    Stream to print to
+  * @param names     Name of each phase
+  */
+extern void profile_print(const profile_t *profile, FILE *stream, const char *const *names);
+
+/** Stops counting, and frees a profile.
+  * @param profile   Profile to close, which may be NULL
+  */
+extern void profile_close(profile_t *profile);
+
+/*}*/
+#endif /* ifndef PROFILE_H */
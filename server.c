@@ -0,0 +1,850 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *
+ *              C E D A R
+ *          S O L U T I O N S       "Software done right."
+ *           S O F T W A R E
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *
+ * Copyright (c) 2000-2004,2007,2013,2014,2020,2024 Kenneth J. Pronovici.
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License,
+ * Version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Copies of the GNU General Public License are available from
+ * the Free Software Foundation website, http://www.gnu.org/.
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *
+ * Author   : Kenneth J. Pronovici <pronovic@ieee.org>
+ * Language : ANSI C
+ * Project  : banner
+ * Purpose  : Render daemon and client, over a Unix domain socket.
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/********************
+  File documentation
+ ********************/
+
+/** @file
+  * @author Kenneth J. Pronovici
+  * @brief  Render daemon and client, over a Unix domain socket.
+  *
+  * The daemon is a single-threaded event loop built on poll().  Every socket
+  * is non-blocking, and each client has an input buffer that requests are
+  * collected in and an output buffer that responses are rendered into.  A
+  * client's requests aren't read while it has too much output pending, so a
+  * slow reader can't make the daemon buffer without limit.
+  */
+
+
+/****************
+  Included files
+ ****************/
+
+#include "config.h"
+
+#include <stdio.h>
+
+#ifdef HAVE_STDLIB_H
+   #include <stdlib.h>
+#endif
+
+#ifdef HAVE_STRING_H
+   #include <string.h>
+#endif
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/un.h>
+
+#include "libbanner.h"
+#include "server.h"
+
+
+/******************
+  Macro defintions
+ *******************/
+
+/** Minimum free space in a client's input buffer before each read */
+#define READ_SIZE         (16*1024)
+
+/** Pending output (in bytes) beyond which a client's requests aren't read */
+#define MAX_PENDING       (1024*1024)
+
+/** Number of pending connections the listening socket will queue */
+#define LISTEN_BACKLOG    (128)
+
+
+/******************
+  Type definitions
+ ******************/
+
+/** A client connected to the daemon. */
+typedef struct
+{
+   int fd;              /**< Client socket */
+   char *input;         /**< Bytes read from the client, not yet handled */
+   size_t inlength;     /**< Number of bytes in the input buffer */
+   size_t incapacity;   /**< Number of bytes allocated at input */
+   char *output;        /**< Responses not yet written to the client */
+   size_t outlength;    /**< Number of bytes in the output buffer */
+   size_t outposition;  /**< Number of bytes of the output already written */
+   size_t outcapacity;  /**< Number of bytes allocated at output */
+} client_t;
+
+
+/******************
+  Global variables
+ ******************/
+
+/** Set by the signal handler when the daemon should stop. */
+static volatile sig_atomic_t stopping = 0;
+
+
+/*************************
+  stop_serving subroutine
+ *************************/
+/** Signal handler that asks the daemon to stop.
+  * @param signum    Signal that was received
+  */
+
+static void stop_serving(int signum)
+{
+   (void)signum;
+   stopping = 1;
+}
+
+
+/*****************
+  grow subroutine
+ *****************/
+/** Makes sure a buffer has room for at least a certain number of bytes.
+  * @param buffer    Buffer to grow
+  * @param capacity  Number of bytes allocated at the buffer, updated if it grows
+  * @param needed    Number of bytes needed
+  * @return Boolean true (1) if there is room, boolean false (0) otherwise.
+  */
+
+static int grow(char **buffer, size_t *capacity, size_t needed)
+{
+   size_t size = 0;
+   char *data = NULL;
+
+   if(needed <= *capacity)
+   {
+      return(1);
+   }
+
+   size = *capacity > 0 ? *capacity : READ_SIZE;
+   while(size < needed)
+   {
+      size *= 2;
+   }
+
+   data = (char *)realloc(*buffer, size);
+   if(data == NULL)
+   {
+      return(0);
+   }
+
+   *buffer = data;
+   *capacity = size;
+   return(1);
+}
+
+
+/*************************
+  grow_clients subroutine
+ *************************/
+/** Makes room for more clients, and for the poll entries that go with them.
+  * Nothing is lost if there isn't enough memory: the arrays keep the clients
+  * they already had, and just don't get any bigger.
+  * @param clients   Clients being served, moved if the array grows
+  * @param fds       Poll entries, one for the listener and one per client, moved if the array grows
+  * @param capacity  Number of clients there is room for, updated if the arrays grow
+  * @return Boolean true (1) if there is room for more clients, boolean false (0) otherwise.
+  */
+
+static int grow_clients(client_t **clients, struct pollfd **fds, int *capacity)
+{
+   int larger = *capacity > 0 ? *capacity*2 : 16;
+   void *grown = NULL;
+
+   grown = realloc(*clients, larger*sizeof(client_t));
+   if(grown == NULL)
+   {
+      return(0);
+   }
+   *clients = (client_t *)grown;
+
+   grown = realloc(*fds, (larger + 1)*sizeof(struct pollfd));
+   if(grown == NULL)
+   {
+      return(0);
+   }
+   *fds = (struct pollfd *)grown;
+
+   *capacity = larger;
+   return(1);
+}
+
+
+/********************
+  put_u32 subroutine
+ ********************/
+/** Stores a 32-bit unsigned integer in network byte order.
+  * @param buffer    Where to store the integer
+  * @param value     Integer to store
+  */
+
+static void put_u32(char *buffer, unsigned long value)
+{
+   buffer[0] = (char)((value >> 24) & 0xff);
+   buffer[1] = (char)((value >> 16) & 0xff);
+   buffer[2] = (char)((value >> 8) & 0xff);
+   buffer[3] = (char)(value & 0xff);
+}
+
+
+/********************
+  get_u32 subroutine
+ ********************/
+/** Loads a 32-bit unsigned integer stored in network byte order.
+  * @param buffer    Where the integer is stored
+  * @return Integer that was loaded.
+  */
+
+static unsigned long get_u32(const char *buffer)
+{
+   const unsigned char *bytes = (const unsigned char *)buffer;
+
+   return(((unsigned long)bytes[0] << 24) | ((unsigned long)bytes[1] << 16) |
+          ((unsigned long)bytes[2] << 8) | (unsigned long)bytes[3]);
+}
+
+
+/************************
+  open_socket subroutine
+ ************************/
+/** Opens a non-blocking socket listening on a path.
+  * If there is already a socket at the path, but nothing is listening on it
+  * (left over from a daemon that died), it is replaced.
+  * @param path      Path of the socket
+  * @return Listening socket, or -1 with errno set if it couldn't be opened.
+  */
+
+static int open_socket(const char *path)
+{
+   int fd = -1;
+   int probe = -1;
+   int error = 0;
+   struct sockaddr_un address;
+   struct stat st;
+
+   if(strlen(path) >= sizeof(address.sun_path))
+   {
+      errno = ENAMETOOLONG;
+      return(-1);
+   }
+
+   memset(&address, 0, sizeof(address));
+   address.sun_family = AF_UNIX;
+   strcpy(address.sun_path, path);
+
+   if(lstat(path, &st) == 0 && S_ISSOCK(st.st_mode))
+   {
+      probe = socket(AF_UNIX, SOCK_STREAM, 0);
+      if(probe >= 0 && connect(probe, (struct sockaddr *)&address, sizeof(address)) != 0 && errno == ECONNREFUSED)
+      {
+         unlink(path);   /* stale socket */
+      }
+      if(probe >= 0)
+      {
+         close(probe);
+      }
+   }
+
+   fd = socket(AF_UNIX, SOCK_STREAM, 0);
+   if(fd < 0)
+   {
+      return(-1);
+   }
+
+   if(bind(fd, (struct sockaddr *)&address, sizeof(address)) != 0 ||
+      listen(fd, LISTEN_BACKLOG) != 0 ||
+      fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK) != 0)
+   {
+      error = errno;
+      close(fd);
+      errno = error;
+      return(-1);
+   }
+
+   return(fd);
+}
+
+
+/*************************
+  append_block subroutine
+ *************************/
+/** Renders a single banner onto the end of a client's output.
+  * @param client    Client the banner is for
+  * @param font      Font to draw the banner in
+  * @param cache     Cache of rendered banners, or NULL
+  * @param text      Text to render
+  * @param length    Length of the text
+  * @param maxwidth  Maximum width of any one banner line
+  * @return Boolean true (1) if the banner was added, boolean false (0) if there wasn't enough memory.
+  */
+
+static int append_block(client_t *client, const banner_font_t *font, banner_cache_t *cache,
+                        const char *text, size_t length, int maxwidth)
+{
+   banner_metrics_t metrics;
+   const char *cached = NULL;
+   char *out = NULL;
+
+   if(cache != NULL)
+   {
+      cached = banner_cache_render(cache, font, text, length, maxwidth, &metrics);
+      if(cached == NULL)
+      {
+         return(0);
+      }
+   }
+   else
+   {
+      banner_measure(font, text, length, maxwidth, &metrics);
+   }
+
+   if(!grow(&client->output, &client->outcapacity, client->outlength + metrics.size + 2))
+   {
+      return(0);
+   }
+
+   out = client->output + client->outlength;
+   *out++ = '\n';
+   if(cached != NULL)
+   {
+      memcpy(out, cached, metrics.size);
+      out += metrics.size;
+   }
+   else
+   {
+      out += banner_render(font, text, &metrics, out, metrics.size);
+   }
+   *out++ = '\n';
+
+   client->outlength = out - client->output;
+   return(1);
+}
+
+
+/****************************
+  render_response subroutine
+ ****************************/
+/** Renders a banner (or, when wrapping, banners) onto the end of a client's
+  * output, as a response frame.  If the output buffer can't be grown, an
+  * empty banner is sent instead.
+  * @param client    Client the response is for
+  * @param font      Font to draw the banner in
+  * @param cache     Cache of rendered banners, or NULL
+  * @param text      Text to render
+  * @param length    Length of the text
+  * @param maxwidth  Maximum width of any one banner line
+  * @param flags     Request flags
+  */
+
+static void render_response(client_t *client, const banner_font_t *font, banner_cache_t *cache,
+                            const char *text, size_t length, int maxwidth, unsigned long flags)
+{
+   size_t start = client->outlength;
+   size_t block = length;
+   size_t next = length;
+
+   if(!grow(&client->output, &client->outcapacity, start + SERVE_RESPONSE_HEADER))
+   {
+      return;
+   }
+   client->outlength += SERVE_RESPONSE_HEADER;
+
+   do
+   {
+      if(flags & SERVE_FLAG_WRAP)
+      {
+         block = banner_wrap(font, text, length, maxwidth, &next);
+      }
+      if(!append_block(client, font, cache, text, block, maxwidth))
+      {
+         client->outlength = start + SERVE_RESPONSE_HEADER;
+         break;
+      }
+      text += next;
+      length -= next;
+   } while(length > 0);
+
+   put_u32(client->output + start, client->outlength - start - SERVE_RESPONSE_HEADER);
+}
+
+
+/****************************
+  handle_requests subroutine
+ ****************************/
+/** Renders a response for each complete request in a client's input.
+  * Any partial request is left in the input buffer for next time.
+  * @param client    Client to handle requests for
+  * @param font      Font to draw banners in
+  * @param cache     Cache of rendered banners, or NULL
+  * @return Boolean false (0) if the client sent a request that's too long.
+  */
+
+static int handle_requests(client_t *client, const banner_font_t *font, banner_cache_t *cache)
+{
+   size_t position = 0;
+   unsigned long length = 0;
+   unsigned long width = 0;
+   unsigned long flags = 0;
+
+   while(client->inlength - position >= SERVE_REQUEST_HEADER)
+   {
+      length = get_u32(client->input + position);
+      width = get_u32(client->input + position + 4);
+      flags = get_u32(client->input + position + 8);
+
+      if(length > SERVE_MAX_TEXT)
+      {
+         return(0);
+      }
+
+      if(client->inlength - position < SERVE_REQUEST_HEADER + length)
+      {
+         break;   /* wait for the rest of the request */
+      }
+
+      render_response(client, font, cache, client->input + position + SERVE_REQUEST_HEADER, length,
+                      width > 0x7fff ? 0x7fff : (int)width, flags);
+      position += SERVE_REQUEST_HEADER + length;
+   }
+
+   if(position > 0)
+   {
+      memmove(client->input, client->input + position, client->inlength - position);
+      client->inlength -= position;
+   }
+
+   return(1);
+}
+
+
+/************************
+  read_client subroutine
+ ************************/
+/** Reads whatever a client has sent, and handles any complete requests.
+  * @param client    Client to read from
+  * @param font      Font to draw banners in
+  * @param cache     Cache of rendered banners, or NULL
+  * @return Boolean false (0) if the client should be disconnected.
+  */
+
+static int read_client(client_t *client, const banner_font_t *font, banner_cache_t *cache)
+{
+   ssize_t count = 0;
+
+   if(!grow(&client->input, &client->incapacity, client->inlength + READ_SIZE))
+   {
+      return(0);
+   }
+
+   count = read(client->fd, client->input + client->inlength, client->incapacity - client->inlength);
+   if(count < 0)
+   {
+      return(errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR);
+   }
+   else if(count == 0)
+   {
+      return(0);   /* client hung up */
+   }
+
+   client->inlength += count;
+   return(handle_requests(client, font, cache));
+}
+
+
+/*************************
+  write_client subroutine
+ *************************/
+/** Writes as much pending output to a client as it will take.
+  * @param client    Client to write to
+  * @return Boolean false (0) if the client should be disconnected.
+  */
+
+static int write_client(client_t *client)
+{
+   ssize_t count = 0;
+
+   count = write(client->fd, client->output + client->outposition, client->outlength - client->outposition);
+   if(count < 0)
+   {
+      return(errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR);
+   }
+
+   client->outposition += count;
+   if(client->outposition == client->outlength)
+   {
+      client->outposition = 0;
+      client->outlength = 0;
+   }
+
+   return(1);
+}
+
+
+/**************************
+  serve_banners subroutine
+ **************************/
+/** Runs the render daemon until it is interrupted or terminated.
+  * A client that connects when there isn't the memory to keep track of it is
+  * turned away, and the clients already connected are still served.
+  * @param path      Path of the socket to listen on
+  * @param font      Font to draw banners in
+  * @param cache     Cache of rendered banners, or NULL
+  * @return Boolean false (0) with errno set if the daemon couldn't be started or had to stop.
+  */
+
+int serve_banners(const char *path, const banner_font_t *font, banner_cache_t *cache)
+{
+   int listener = -1;
+   int fd = -1;
+   int i = 0;
+   int count = 0;
+   int capacity = 0;
+   int served = 1;
+   int error = 0;
+   client_t *clients = NULL;
+   struct pollfd *fds = NULL;
+
+   listener = open_socket(path);
+   if(listener < 0)
+   {
+      return(0);
+   }
+
+   if(!grow_clients(&clients, &fds, &capacity))
+   {
+      free(clients);
+      free(fds);
+      close(listener);
+      unlink(path);
+      errno = ENOMEM;
+      return(0);
+   }
+
+   signal(SIGPIPE, SIG_IGN);
+   signal(SIGINT, stop_serving);
+   signal(SIGTERM, stop_serving);
+
+   while(!stopping)
+   {
+      fds[0].fd = listener;
+      fds[0].events = POLLIN;
+      fds[0].revents = 0;
+      for(i=0; i<count; i++)
+      {
+         fds[i+1].fd = clients[i].fd;
+         fds[i+1].events = 0;
+         fds[i+1].revents = 0;
+         if(clients[i].outlength - clients[i].outposition < MAX_PENDING)
+         {
+            fds[i+1].events |= POLLIN;
+         }
+         if(clients[i].outlength > clients[i].outposition)
+         {
+            fds[i+1].events |= POLLOUT;
+         }
+      }
+
+      if(poll(fds, count + 1, -1) < 0)
+      {
+         if(errno == EINTR)
+         {
+            continue;
+         }
+         served = 0;
+         error = errno;
+         break;
+      }
+
+      /* Handle existing clients first, so the arrays line up */
+      for(i=count-1; i>=0; i--)
+      {
+         if(fds[i+1].revents == 0)
+         {
+            continue;
+         }
+
+         if(((fds[i+1].revents & POLLOUT) && !write_client(&clients[i])) ||
+            ((fds[i+1].revents & (POLLIN | POLLHUP)) && !read_client(&clients[i], font, cache)) ||
+            (fds[i+1].revents & (POLLERR | POLLNVAL)))
+         {
+            close(clients[i].fd);
+            free(clients[i].input);
+            free(clients[i].output);
+            clients[i] = clients[--count];
+         }
+      }
+
+      if(fds[0].revents & POLLIN)
+      {
+         fd = accept(listener, NULL, NULL);
+         if(fd >= 0 && count == capacity && !grow_clients(&clients, &fds, &capacity))
+         {
+            close(fd);   /* no room to keep track of another client */
+            fd = -1;
+         }
+         if(fd >= 0)
+         {
+            fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+            memset(&clients[count], 0, sizeof(client_t));
+            clients[count++].fd = fd;
+         }
+      }
+   }
+
+   for(i=0; i<count; i++)
+   {
+      close(clients[i].fd);
+      free(clients[i].input);
+      free(clients[i].output);
+   }
+
+   free(clients);
+   free(fds);
+   close(listener);
+   unlink(path);
+
+   if(!served)
+   {
+      errno = error;
+   }
+   return(served);
+}
+
+
+/**********************
+  write_all subroutine
+ **********************/
+/** Writes an entire buffer to a blocking descriptor.
+  * @param fd        Descriptor to write to
+  * @param buffer    Bytes to write
+  * @param length    Number of bytes to write
+  * @return Boolean true (1) on success, boolean false (0) otherwise.
+  */
+
+static int write_all(int fd, const char *buffer, size_t length)
+{
+   ssize_t count = 0;
+
+   while(length > 0)
+   {
+      count = write(fd, buffer, length);
+      if(count < 0 && errno == EINTR)
+      {
+         continue;
+      }
+      if(count <= 0)
+      {
+         return(0);
+      }
+
+      buffer += count;
+      length -= count;
+   }
+
+   return(1);
+}
+
+
+/*********************
+  read_all subroutine
+ *********************/
+/** Reads an exact number of bytes from a blocking descriptor.
+  * @param fd        Descriptor to read from
+  * @param buffer    Where to store the bytes
+  * @param length    Number of bytes to read
+  * @return Boolean true (1) on success, boolean false (0) otherwise.
+  */
+
+static int read_all(int fd, char *buffer, size_t length)
+{
+   ssize_t count = 0;
+
+   while(length > 0)
+   {
+      count = read(fd, buffer, length);
+      if(count < 0 && errno == EINTR)
+      {
+         continue;
+      }
+      if(count <= 0)
+      {
+         if(count == 0)
+         {
+            errno = ECONNRESET;
+         }
+         return(0);
+      }
+
+      buffer += count;
+      length -= count;
+   }
+
+   return(1);
+}
+
+
+/***************************
+  request_banner subroutine
+ ***************************/
+/** Sends one render request to the daemon and prints the response.
+  * @param fd        Socket connected to the daemon
+  * @param text      Text to render
+  * @param length    Length of the text
+  * @param maxwidth  Maximum width of any one banner line
+  * @param flags     Request flags
+  * @param response  Buffer the response is read into, grown as needed
+  * @param capacity  Number of bytes allocated at the response buffer
+  * @return Boolean true (1) on success, boolean false (0) otherwise.
+  */
+
+static int request_banner(int fd, const char *text, size_t length, int maxwidth, unsigned long flags,
+                          char **response, size_t *capacity)
+{
+   char header[SERVE_REQUEST_HEADER];
+   unsigned long size = 0;
+
+   if(length > SERVE_MAX_TEXT)
+   {
+      length = SERVE_MAX_TEXT;   /* the daemon won't take any more */
+   }
+
+   put_u32(header, length);
+   put_u32(header + 4, maxwidth > 0 ? maxwidth : 0);
+   put_u32(header + 8, flags);
+
+   if(!write_all(fd, header, SERVE_REQUEST_HEADER) ||
+      !write_all(fd, text, length) ||
+      !read_all(fd, header, SERVE_RESPONSE_HEADER))
+   {
+      return(0);
+   }
+
+   size = get_u32(header);
+   if(!grow(response, capacity, size) || !read_all(fd, *response, size))
+   {
+      return(0);
+   }
+
+   fwrite(*response, 1, size, stdout);
+   return(1);
+}
+
+
+/***************************
+  client_banners subroutine
+ ***************************/
+/** Asks a render daemon to render each word, and prints the results.
+  * @param path      Path of the socket the daemon is listening on
+  * @param words     Words to print, or NULL to print each line of standard input
+  * @param wordcount Number of words to print
+  * @param maxwidth  Maximum width of any one banner line
+  * @param flags     Request flags, a combination of the @c SERVE_FLAG_ options
+  * @return Boolean true (1) on success, boolean false (0) with errno set otherwise.
+  */
+
+int client_banners(const char *path, char **words, int wordcount, int maxwidth, unsigned long flags)
+{
+   int fd = -1;
+   int i = 0;
+   int ok = 1;
+   int error = 0;
+   struct sockaddr_un address;
+   char *response = NULL;
+   size_t capacity = 0;
+   char *line = NULL;
+   size_t size = 0;
+   ssize_t length = 0;
+
+   if(strlen(path) >= sizeof(address.sun_path))
+   {
+      errno = ENAMETOOLONG;
+      return(0);
+   }
+
+   memset(&address, 0, sizeof(address));
+   address.sun_family = AF_UNIX;
+   strcpy(address.sun_path, path);
+
+   fd = socket(AF_UNIX, SOCK_STREAM, 0);
+   if(fd < 0)
+   {
+      return(0);
+   }
+
+   if(connect(fd, (struct sockaddr *)&address, sizeof(address)) != 0)
+   {
+      error = errno;
+      close(fd);
+      errno = error;
+      return(0);
+   }
+
+   signal(SIGPIPE, SIG_IGN);
+
+   if(words != NULL)
+   {
+      for(i=0; ok && i<wordcount; i++)
+      {
+         ok = request_banner(fd, words[i], strlen(words[i]), maxwidth, flags, &response, &capacity);
+      }
+   }
+   else
+   {
+      while(ok && (length = getline(&line, &size, stdin)) != -1)
+      {
+         if(length > 0 && line[length - 1] == '\n')
+         {
+            length--;
+         }
+
+         if(length > 0 && line[length - 1] == '\r')
+         {
+            length--;
+         }
+
+         ok = request_banner(fd, line, length, maxwidth, flags, &response, &capacity);
+      }
+   }
+
+   error = errno;
+   free(line);
+   free(response);
+   close(fd);
+   errno = error;
+
+   return(ok);
+}
+
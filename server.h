@@ -0,0 +1,105 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *
+ *              C E D A R
+ *          S O L U T I O N S       "Software done right."
+ *           S O F T W A R E
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *
+ * Copyright (c) 2000-2004,2007,2013,2014,2020,2024 Kenneth J. Pronovici.
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License,
+ * Version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Copies of the GNU General Public License are available from
+ * the Free Software Foundation website, http://www.gnu.org/.
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *
+ * Author   : Kenneth J. Pronovici <pronovic@ieee.org>
+ * Language : ANSI C
+ * Project  : banner
+ * Purpose  : Render daemon and client, over a Unix domain socket.
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/********************
+  File documentation
+ ********************/
+
+/** @file
+  * @author Kenneth J. Pronovici
+  * @brief  Render daemon and client, over a Unix domain socket.
+  *
+  * The daemon answers render requests over a stream socket.  Each request
+  * and each response is a frame made up of a header of 32-bit unsigned
+  * integers in network byte order, followed by a payload:
+  *
+    @verbatim
+
+      request:   length  width  flags  text[length]
+      response:  length  banner[length]
+
+    @endverbatim
+  *
+  * The text is the string to print, the width is the print width to use,
+  * and the flags are a combination of the @c SERVE_FLAG_ options, with any
+  * other bits zero.  The banner in the response is exactly what the banner
+  * program would have printed, including the blank lines around it.  A client may send any number of
+  * requests on one connection, and responses come back in the same order.
+  */
+
+#ifndef SERVER_H
+#define SERVER_H
+/*{*/
+
+#include "libbanner.h"
+
+
+/******************
+  Macro defintions
+ *******************/
+
+/** Size of a request header, in bytes */
+#define SERVE_REQUEST_HEADER  (12)
+
+/** Size of a response header, in bytes */
+#define SERVE_RESPONSE_HEADER (4)
+
+/** Longest text accepted in a request; longer requests close the connection */
+#define SERVE_MAX_TEXT        (64*1024)
+
+/** Request flag to wrap text that doesn't fit onto more banners, as with --wrap */
+#define SERVE_FLAG_WRAP       (1)
+
+
+/***********************
+  Function declarations
+ ***********************/
+
+/** Runs the render daemon until it is interrupted or terminated.
+  * @param path      Path of the socket to listen on
+  * @param font      Font to draw banners in
+  * @param cache     Cache of rendered banners, or NULL
+  * @return Boolean false (0) with errno set if the daemon couldn't be started or had to stop.
+  */
+extern int serve_banners(const char *path, const banner_font_t *font, banner_cache_t *cache);
+
+/** Asks a render daemon to render each word, and prints the results.
+  * @param path      Path of the socket the daemon is listening on
+  * @param words     Words to print, or NULL to print each line of standard input
+  * @param wordcount Number of words to print
+  * @param maxwidth  Maximum width of any one banner line
+  * @param flags     Request flags, a combination of the @c SERVE_FLAG_ options
+  * @return Boolean true (1) on success, boolean false (0) with errno set otherwise.
+  */
+extern int client_banners(const char *path, char **words, int wordcount, int maxwidth, unsigned long flags);
+
+/*}*/
+#endif /* ifndef SERVER_H */
@@ -0,0 +1,292 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *
+ *              C E D A R
+ *          S O L U T I O N S       "Software done right."
+ *           S O F T W A R E
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *
+ * Copyright (c) 2000-2004,2007,2013,2014,2020,2024 Kenneth J. Pronovici.
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License,
+ * Version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Copies of the GNU General Public License are available from
+ * the Free Software Foundation website, http://www.gnu.org/.
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *
+ * Author   : Kenneth J. Pronovici <pronovic@ieee.org>
+ * Language : ANSI C
+ * Project  : banner
+ * Purpose  : Vertical (line-printer) banners, from fonts turned on their side.
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/********************
+  File documentation
+ ********************/
+
+/** @file
+  * @author Kenneth J. Pronovici
+  * @brief  Vertical (line-printer) banners, from fonts turned on their side.
+  *
+  * A vertical banner runs down the page, one letter under another, like the
+  * banners old line printers used to print on fanfold paper.  Since each
+  * letter is a run of whole lines, a banner never has to be built up before
+  * it's printed: the lines for each character are copied out as soon as the
+  * character is read, and there's no limit on how long the banner can be.
+  *
+  * All of the work of turning the letters is done once, when the font is
+  * turned.  Every letter the font was made from gets a block of lines, one
+  * for each of its columns (and its spacing), with its bottom row on the
+  * left and its top row on the right.  Characters that are folded onto a
+  * letter (lower-case letters and whitespace) share its block, so rendering
+  * a character is one glyph lookup and one copy.
+  */
+
+
+/****************
+  Included files
+ ****************/
+
+#include "config.h"
+
+#ifdef HAVE_STDLIB_H
+   #include <stdlib.h>
+#endif
+
+#ifdef HAVE_STRING_H
+   #include <string.h>
+#endif
+
+#include "libbanner.h"
+#include "font.h"
+
+
+/******************
+  Type definitions
+ ******************/
+
+/** A font turned on its side. */
+struct banner_vertical
+{
+   const banner_font_t *font;   /**< Font the letters were turned from */
+   int width;                   /**< Width of each line, not including the newline */
+   size_t *offsets;             /**< Offset of each glyph's block of lines, by glyph table slot */
+   char *lines;                 /**< Blocks of lines for every letter, one after another */
+};
+
+
+/***********************
+  block_size subroutine
+ ***********************/
+/** Returns the size of the block of lines a glyph is printed with.
+  * @param vertical  Font turned on its side
+  * @param glyph     Glyph to print, which must be present
+  * @return Size of the block, in bytes.
+  */
+
+static size_t block_size(const banner_vertical_t *vertical, const glyph_t *glyph)
+{
+   return((size_t)(glyph->width + vertical->font->space)*(vertical->width + 1));
+}
+
+
+/***********************
+  turn_glyph subroutine
+ ***********************/
+/** Turns one letter on its side, into its block of lines.
+  * The font's row scale, which repeats rows down the page for a horizontal
+  * banner, repeats them across the line instead.
+  * @param vertical  Font turned on its side
+  * @param glyph     Glyph of the letter, which must be present
+  * @param block     Where to put the block of lines
+  */
+
+static void turn_glyph(const banner_vertical_t *vertical, const glyph_t *glyph, char *block)
+{
+   const banner_font_t *font = vertical->font;
+   int column = 0;
+   int x = 0;
+
+   for(column=0; column<glyph->width + font->space; column++)
+   {
+      for(x=0; x<vertical->width; x++)
+      {
+         if(column < glyph->width)
+         {
+            block[x] = banner_glyph_pixel(font, glyph, font->height - 1 - x/font->scale, column);
+         }
+         else
+         {
+            block[x] = ' ';
+         }
+      }
+      block[vertical->width] = '\n';
+      block += vertical->width + 1;
+   }
+}
+
+
+/***********************************
+  banner_vertical_create subroutine
+ ***********************************/
+/** Turns a font on its side, for printing banners down the page.
+  * Blocks are made for the letters the font was made from, in the order of
+  * the glyph table, and then the characters folded onto them are pointed
+  * at the same blocks.
+  * @param font      Font to turn
+  * @param maxwidth  Maximum width of any one line
+  * @return Font turned on its side, or NULL if there wasn't enough memory.
+  */
+
+banner_vertical_t *banner_vertical_create(const banner_font_t *font, int maxwidth)
+{
+   banner_vertical_t *vertical = NULL;
+   const glyph_t *glyph = NULL;
+   size_t slots = (size_t)font->pages*GLYPH_PAGE_SIZE;
+   size_t size = 0;
+   size_t i = 0;
+
+   vertical = (banner_vertical_t *)calloc(1, sizeof(banner_vertical_t));
+   if(vertical == NULL)
+   {
+      return(NULL);
+   }
+
+   vertical->font = font;
+   vertical->width = font->height*font->scale;
+   if(vertical->width + 1 > maxwidth)
+   {
+      vertical->width = maxwidth > 1 ? maxwidth - 1 : 0;
+   }
+
+   vertical->offsets = (size_t *)malloc(slots*sizeof(size_t));
+   if(vertical->offsets == NULL)
+   {
+      banner_vertical_destroy(vertical);
+      return(NULL);
+   }
+
+   for(i=0; i<slots; i++)
+   {
+      glyph = &font->glyphs[i];
+      if(glyph->present && FONT_GLYPH(font, glyph->code) == glyph)
+      {
+         vertical->offsets[i] = size;
+         size += block_size(vertical, glyph);
+      }
+   }
+
+   vertical->lines = (char *)malloc(size > 0 ? size : 1);
+   if(vertical->lines == NULL)
+   {
+      banner_vertical_destroy(vertical);
+      return(NULL);
+   }
+
+   for(i=0; i<slots; i++)
+   {
+      glyph = &font->glyphs[i];
+      if(glyph->present && FONT_GLYPH(font, glyph->code) == glyph)
+      {
+         turn_glyph(vertical, glyph, vertical->lines + vertical->offsets[i]);
+      }
+   }
+
+   for(i=0; i<slots; i++)
+   {
+      glyph = &font->glyphs[i];
+      if(glyph->present && FONT_GLYPH(font, glyph->code) != glyph)
+      {
+         vertical->offsets[i] = vertical->offsets[FONT_GLYPH(font, glyph->code) - font->glyphs];
+      }
+   }
+
+   return(vertical);
+}
+
+
+/************************************
+  banner_vertical_destroy subroutine
+ ************************************/
+/** Frees a font turned on its side by banner_vertical_create().
+  * @param vertical  Font to free, which may be NULL
+  */
+
+void banner_vertical_destroy(banner_vertical_t *vertical)
+{
+   if(vertical == NULL)
+   {
+      return;
+   }
+
+   free(vertical->offsets);
+   free(vertical->lines);
+   free(vertical);
+}
+
+
+/***********************************
+  banner_vertical_render subroutine
+ ***********************************/
+/** Renders as much of a string as fits into a buffer, as a vertical banner.
+  * @param vertical  Font turned on its side
+  * @param string    String to be rendered, which need not be null-terminated
+  * @param length    Length of the string
+  * @param position  Where to start in the string, updated to where to carry on
+  * @param buffer    Buffer to render into
+  * @param size      Size of the buffer
+  * @return Number of bytes written.
+  */
+
+size_t banner_vertical_render(const banner_vertical_t *vertical, const char *string, size_t length,
+                              size_t *position, char *buffer, size_t size)
+{
+   const banner_font_t *font = vertical->font;
+   const glyph_t *glyph = NULL;
+   size_t written = 0;
+   size_t next = 0;
+   size_t block = 0;
+   int32_t code = 0;
+   unsigned char c = 0;
+
+   while(*position < length)
+   {
+      next = *position;
+      c = (unsigned char)string[next];
+      if(c < 0x80)
+      {
+         glyph = &font->glyphs[c];
+         next++;
+      }
+      else
+      {
+         code = banner_decode(string, length, &next);
+         glyph = FONT_GLYPH(font, code);
+      }
+
+      if(glyph->present)
+      {
+         block = block_size(vertical, glyph);
+         if(block > size - written)
+         {
+            break;   /* the rest goes in the next buffer */
+         }
+
+         memcpy(buffer + written, vertical->lines + vertical->offsets[glyph - font->glyphs], block);
+         written += block;
+      }
+
+      *position = next;
+   }
+
+   return(written);
+}